@@ -17,6 +17,18 @@
 #define GESTURE_DOWN_LEFT  (GESTURE_DOWN | GESTURE_LEFT)
 #define GESTURE_DOWN_RIGHT (GESTURE_DOWN | GESTURE_RIGHT)
 
+// 16-way gesture direction constants (in-between directions, requires directions = <16>)
+// The low nibble is the clockwise sector index on a 16-way compass, 0 being GESTURE_UP
+#define GESTURE_16WAY(sector) (0x10 | (sector))
+#define GESTURE_UP_UP_RIGHT       GESTURE_16WAY(1)
+#define GESTURE_RIGHT_UP_RIGHT    GESTURE_16WAY(3)
+#define GESTURE_RIGHT_DOWN_RIGHT  GESTURE_16WAY(5)
+#define GESTURE_DOWN_DOWN_RIGHT   GESTURE_16WAY(7)
+#define GESTURE_DOWN_DOWN_LEFT    GESTURE_16WAY(9)
+#define GESTURE_LEFT_DOWN_LEFT    GESTURE_16WAY(11)
+#define GESTURE_LEFT_UP_LEFT      GESTURE_16WAY(13)
+#define GESTURE_UP_UP_LEFT        GESTURE_16WAY(15)
+
 #define GESTURE_X(x) (x > 0 ? GESTURE_RIGHT : GESTURE_LEFT)
 #define GESTURE_Y(y) (y > 0 ? GESTURE_DOWN : GESTURE_UP)
 #define GESTURE_XY(x, y) (GESTURE_X(x) | GESTURE_Y(y))
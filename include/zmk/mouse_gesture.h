@@ -7,10 +7,31 @@
 #pragma once
 
 #include <stdbool.h>
+#include <zephyr/sys/slist.h>
 
 /**
  * @brief Check if mouse gesture is currently active
  * 
  * @return true if mouse gesture is active, false otherwise
  */
-bool zmk_mouse_gesture_is_active(void);
\ No newline at end of file
+bool zmk_mouse_gesture_is_active(void);
+
+/**
+ * @brief Listener notified on mouse gesture activation edges
+ *
+ * The callback runs in the context that changed the state (usually the keymap),
+ * only when the state actually flips, and must not block.
+ */
+struct zmk_mouse_gesture_listener {
+    sys_snode_t node;
+    void (*state_changed)(struct zmk_mouse_gesture_listener *listener, bool active);
+};
+
+/**
+ * @brief Register a listener for activation edges
+ *
+ * Intended to be called once during device initialization.
+ *
+ * @param listener Listener to register, must stay valid forever
+ */
+void zmk_mouse_gesture_add_listener(struct zmk_mouse_gesture_listener *listener);
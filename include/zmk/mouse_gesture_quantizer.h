@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Direction quantizer. Directions are clockwise sectors of a 16-way compass, 0 being up
+ * and screen coordinates having Y pointing down. Within a quadrant the angle from the
+ * horizontal axis is compared against the boundaries between sectors as
+ * tan(angle) = |y| / |x|, i.e. |y| << 16 against |x| * tan(boundary) in Q16. A stroke
+ * falling between lower[i] and upper[i] lies in the dead zone around boundary i and
+ * yields no direction.
+ *
+ * The code does not depend on Zephyr, so it can be tested on the host.
+ */
+
+#define GESTURE_DIRECTION_CODES 16
+#define GESTURE_SECTOR_NONE 0xFF
+
+// Quadrant boundaries of the finest (16-way) quantizer
+#define MAX_GESTURE_BOUNDARIES (GESTURE_DIRECTION_CODES / 4)
+
+struct gesture_quantizer {
+    uint8_t boundary_count;  // Boundaries per quadrant: directions / 4
+    uint8_t sector_step;     // Compass sectors per direction: 16 / directions
+    uint32_t lower[MAX_GESTURE_BOUNDARIES];
+    uint32_t upper[MAX_GESTURE_BOUNDARIES];
+};
+
+// Thresholds, folded to integers by the compiler for constant arguments.
+// tan(boundary +/- half dead zone) uses the tangent addition formula.
+#define GESTURE_TAN_11_25 0.19891236737965800
+#define GESTURE_TAN_22_5  0.41421356237309503
+#define GESTURE_TAN_33_75 0.66817863791929890
+#define GESTURE_TAN_45    1.0
+#define GESTURE_TAN_56_25 1.49660576266548900
+#define GESTURE_TAN_67_5  2.41421356237309500
+#define GESTURE_TAN_78_75 5.02733949212584800
+
+// Continued fraction of tan(r), accurate to 1e-8 up to the widest half dead zone of 45 degrees
+#define GESTURE_TAN(r)                                                                             \
+    ((r) / (1.0 - (r) * (r) / (3.0 - (r) * (r) / (5.0 - (r) * (r) / (7.0 - (r) * (r) / 9.0)))))
+#define GESTURE_HALF_DEAD_ZONE_TAN(dead_zone_deg)                                                  \
+    GESTURE_TAN((dead_zone_deg) * 0.00872664625997164788)  // deg / 2 in rad
+#define GESTURE_Q16(t) ((uint32_t)((t) * 65536.0 + 0.5))
+#define GESTURE_LOWER(dz, tb)                                                                      \
+    GESTURE_Q16(((tb) - GESTURE_HALF_DEAD_ZONE_TAN(dz)) /                                          \
+                (1.0 + (tb) * GESTURE_HALF_DEAD_ZONE_TAN(dz)))
+#define GESTURE_UPPER(dz, tb)                                                                      \
+    GESTURE_Q16(((tb) + GESTURE_HALF_DEAD_ZONE_TAN(dz)) /                                          \
+                (1.0 - (tb) * GESTURE_HALF_DEAD_ZONE_TAN(dz)))
+
+#define GESTURE_BOUNDARY_TABLE(directions, dz, bound)                                              \
+    {                                                                                              \
+        (directions) == 16  ? bound(dz, GESTURE_TAN_11_25)                                         \
+        : (directions) == 8 ? bound(dz, GESTURE_TAN_22_5)                                          \
+                            : bound(dz, GESTURE_TAN_45),                                           \
+        (directions) == 16  ? bound(dz, GESTURE_TAN_33_75)                                         \
+        : (directions) == 8 ? bound(dz, GESTURE_TAN_67_5)                                          \
+                            : 0,                                                                   \
+        (directions) == 16 ? bound(dz, GESTURE_TAN_56_25) : 0,                                     \
+        (directions) == 16 ? bound(dz, GESTURE_TAN_78_75) : 0,                                     \
+    }
+
+/**
+ * @brief Initializer of a quantizer
+ *
+ * @param directions 4, 8 or 16
+ * @param dead_zone_deg Width of the dead zone around each boundary, below 360 / directions
+ */
+#define GESTURE_QUANTIZER_INIT(directions, dead_zone_deg)                                          \
+    {                                                                                              \
+        .boundary_count = (directions) / 4,                                                        \
+        .sector_step = GESTURE_DIRECTION_CODES / (directions),                                     \
+        .lower = GESTURE_BOUNDARY_TABLE(directions, dead_zone_deg, GESTURE_LOWER),                 \
+        .upper = GESTURE_BOUNDARY_TABLE(directions, dead_zone_deg, GESTURE_UPPER),                 \
+    }
+
+/**
+ * @brief Quantize a movement vector
+ *
+ * @return Compass sector of the direction, a multiple of the quantizer's sector step, or
+ *         GESTURE_SECTOR_NONE inside a dead zone
+ */
+static inline uint8_t gesture_detect_direction(int32_t x, int32_t y,
+                                               const struct gesture_quantizer *quantizer) {
+    // Unsigned magnitudes, so INT32_MIN and large accumulators are not truncated
+    uint32_t abs_x = x < 0 ? 0u - (uint32_t)x : (uint32_t)x;
+    uint32_t abs_y = y < 0 ? 0u - (uint32_t)y : (uint32_t)y;
+    uint64_t scaled_y = (uint64_t)abs_y << 16;
+
+    // Steps from the horizontal axis towards the vertical one within the quadrant
+    uint8_t steps = 0;
+    for (; steps < quantizer->boundary_count; steps++) {
+        if (scaled_y < (uint64_t)abs_x * quantizer->upper[steps]) {
+            if (scaled_y > (uint64_t)abs_x * quantizer->lower[steps]) {
+                return GESTURE_SECTOR_NONE;  // Too close to a sector boundary
+            }
+            break;
+        }
+    }
+
+    uint8_t offset = steps * quantizer->sector_step;
+
+    if (x > 0) {
+        return y > 0 ? 4 + offset : 4 - offset;  // From right towards down / up
+    } else {
+        return y > 0 ? 12 - offset : (12 + offset) & 0xF;  // From left towards down / up
+    }
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Shape recognizer in the spirit of the $1 unistroke recognizer, in integer math only.
+ *
+ * A path is normalized by resampling it to a fixed number of equidistant points,
+ * rotating it so the vector from its centroid to its first point lies on the +X axis,
+ * and scaling it uniformly into a box of ZMK_GESTURE_SHAPE_SIZE around the centroid.
+ * Two normalized shapes are compared by their average point-to-point distance.
+ *
+ * The code does not depend on Zephyr, so it can be benchmarked on the host.
+ */
+
+// Side of the box normalized shapes are scaled into
+#define ZMK_GESTURE_SHAPE_SIZE 1024
+
+struct zmk_gesture_shape_point {
+    int16_t x;
+    int16_t y;
+};
+
+/**
+ * @brief Normalize a path for comparison
+ *
+ * @param xy Path points as interleaved X/Y coordinates
+ * @param count Number of points in the path
+ * @param out Normalized shape
+ * @param out_count Number of points to resample the path to, at least 2
+ *
+ * @return 0 on success, -EINVAL if the path has no extent to normalize
+ */
+int zmk_gesture_shape_normalize(const int32_t *xy, size_t count,
+                                struct zmk_gesture_shape_point *out, size_t out_count);
+
+/**
+ * @brief Average distance between two normalized shapes
+ *
+ * @param a First shape
+ * @param b Second shape
+ * @param count Number of points in each shape
+ *
+ * @return Distance in thousandths of ZMK_GESTURE_SHAPE_SIZE
+ */
+uint32_t zmk_gesture_shape_distance(const struct zmk_gesture_shape_point *a,
+                                    const struct zmk_gesture_shape_point *b, size_t count);
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/util_macro.h>
+
+/*
+ * Motion trace format (version 1)
+ *
+ * A trace is a sequence of variable-length records:
+ *   varint   time since the previous record, in microseconds
+ *   uint8_t  tag: bits 0-1 kind, bit 2 input sync flag
+ *   varint   zigzag-encoded value (REL X/Y records only)
+ *
+ * Varints are little-endian base-128. The oldest records are dropped when the
+ * buffer is full, so the first record's time delta is relative to a record that
+ * is no longer present.
+ */
+#define MOUSE_GESTURE_TRACE_VERSION 1
+
+#define MOUSE_GESTURE_TRACE_KIND_REL_X 0
+#define MOUSE_GESTURE_TRACE_KIND_REL_Y 1
+#define MOUSE_GESTURE_TRACE_KIND_ACTIVATE 2
+#define MOUSE_GESTURE_TRACE_KIND_DEACTIVATE 3
+#define MOUSE_GESTURE_TRACE_KIND_MASK 0x03
+#define MOUSE_GESTURE_TRACE_SYNC BIT(2)
+
+/**
+ * @brief Append a raw REL X/Y event to the trace
+ *
+ * @param code INPUT_REL_X or INPUT_REL_Y
+ * @param value Relative movement
+ * @param sync Input event sync flag
+ */
+void zmk_mouse_gesture_trace_motion(uint16_t code, int32_t value, bool sync);
+
+/**
+ * @brief Append a gesture activation edge to the trace
+ *
+ * @param active New activation state
+ */
+void zmk_mouse_gesture_trace_activation(bool active);
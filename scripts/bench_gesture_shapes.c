@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Host benchmark for the shape recognizer. Builds a few templates, draws noisy,
+ * rotated and scaled versions of them, and reports recognition accuracy and the cost
+ * of one gesture end: normalizing the recorded path and every template, and comparing.
+ *
+ *   cc -O2 -Iinclude scripts/bench_gesture_shapes.c src/mouse_gesture_shape.c -lm \
+ *       -o bench_gesture_shapes && ./bench_gesture_shapes
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <zmk/mouse_gesture_shape.h>
+
+#define RESAMPLED_POINTS 32  // CONFIG_ZMK_MOUSE_GESTURE_SHAPE_POINTS
+#define PATH_POINTS 64       // CONFIG_ZMK_MOUSE_GESTURE_SHAPE_PATH_POINTS
+#define TEMPLATE_POINTS 16
+#define TRIALS 20000
+#ifndef MAX_DISTANCE
+#define MAX_DISTANCE 120  // shape-max-distance default
+#endif
+
+enum { CIRCLE_CW, CIRCLE_CCW, CHECKMARK, ZIGZAG, TRIANGLE, SHAPE_COUNT };
+
+static const char *const names[] = {"circle cw", "circle ccw", "checkmark", "zigzag", "triangle"};
+
+// Point on the unit outline of a shape, t in [0, 1]; screen coordinates, Y down
+static void outline(int shape, double t, double *x, double *y) {
+    switch (shape) {
+    case CIRCLE_CW:
+        *x = sin(2 * M_PI * t);
+        *y = -cos(2 * M_PI * t);
+        break;
+    case CIRCLE_CCW:
+        *x = -sin(2 * M_PI * t);
+        *y = -cos(2 * M_PI * t);
+        break;
+    case CHECKMARK:
+        if (t < 0.3) {
+            *x = t / 0.3 * 0.4;
+            *y = t / 0.3 * 0.4;
+        } else {
+            *x = 0.4 + (t - 0.3) / 0.7 * 0.8;
+            *y = 0.4 - (t - 0.3) / 0.7 * 1.2;
+        }
+        break;
+    case ZIGZAG: {
+        double u = t * 3;
+        int seg = u >= 3 ? 2 : (int)u;
+        double f = u - seg;
+        *x = (seg + f) / 3;
+        *y = (seg % 2 == 0) ? f * 0.5 : 0.5 - f * 0.5;
+        break;
+    }
+    case TRIANGLE:
+    default: {
+        static const double vx[] = {0, 0.5, -0.5, 0}, vy[] = {-0.5, 0.4, 0.4, -0.5};
+        double u = t * 3;
+        int seg = u >= 3 ? 2 : (int)u;
+        double f = u - seg;
+        *x = vx[seg] + (vx[seg + 1] - vx[seg]) * f;
+        *y = vy[seg] + (vy[seg + 1] - vy[seg]) * f;
+        break;
+    }
+    }
+}
+
+static double noise(double amount) {
+    return ((double)rand() / RAND_MAX * 2 - 1) * amount;
+}
+
+// Draw a shape as the processor would record it: integer counts, rotated, scaled, jittered
+static size_t draw(int shape, size_t points, double scale, double angle, double jitter,
+                   int32_t *xy) {
+    for (size_t i = 0; i < points; i++) {
+        double x, y;
+        outline(shape, (double)i / (points - 1), &x, &y);
+        double rx = x * cos(angle) - y * sin(angle);
+        double ry = x * sin(angle) + y * cos(angle);
+        xy[2 * i] = (int32_t)lround(rx * scale + noise(jitter * scale));
+        xy[2 * i + 1] = (int32_t)lround(ry * scale + noise(jitter * scale));
+    }
+    return points;
+}
+
+int main(void) {
+    static int32_t templates[SHAPE_COUNT][2 * TEMPLATE_POINTS];
+    static int32_t path[2 * PATH_POINTS];
+    struct zmk_gesture_shape_point candidate[RESAMPLED_POINTS];
+    struct zmk_gesture_shape_point reference[RESAMPLED_POINTS];
+    size_t correct = 0;
+    uint64_t worst_distance = 0;
+
+    // Templates as they would be written in the devicetree: few points, unit-ish scale
+    for (int s = 0; s < SHAPE_COUNT; s++) {
+        draw(s, TEMPLATE_POINTS, 100, 0, 0, templates[s]);
+    }
+
+    srand(1);
+    double total_ns = 0;
+
+    for (int trial = 0; trial < TRIALS; trial++) {
+        int shape = trial % SHAPE_COUNT;
+        size_t points = draw(shape, 24 + rand() % (PATH_POINTS - 24), 200 + rand() % 3000,
+                             noise(0.3), 0.04, path);
+
+        // Only the work done at a gesture end is timed
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        if (zmk_gesture_shape_normalize(path, points, candidate, RESAMPLED_POINTS) != 0) {
+            continue;
+        }
+
+        int best = -1;
+        uint32_t best_distance = UINT32_MAX;
+        for (int s = 0; s < SHAPE_COUNT; s++) {
+            zmk_gesture_shape_normalize(templates[s], TEMPLATE_POINTS, reference,
+                                        RESAMPLED_POINTS);
+            uint32_t distance = zmk_gesture_shape_distance(candidate, reference, RESAMPLED_POINTS);
+            if (distance < best_distance) {
+                best_distance = distance;
+                best = s;
+            }
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        total_ns += (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+
+        if (best == shape) {
+            correct++;
+            worst_distance = best_distance > worst_distance ? best_distance : worst_distance;
+        }
+    }
+
+    double ns = total_ns / TRIALS;
+
+    // Random scribbles should not come close to any template
+    size_t false_matches = 0;
+    for (int trial = 0; trial < TRIALS; trial++) {
+        int32_t x = 0, y = 0;
+        for (size_t i = 0; i < PATH_POINTS; i++) {
+            x += rand() % 201 - 100;
+            y += rand() % 201 - 100;
+            path[2 * i] = x;
+            path[2 * i + 1] = y;
+        }
+        if (zmk_gesture_shape_normalize(path, PATH_POINTS, candidate, RESAMPLED_POINTS) != 0) {
+            continue;
+        }
+        for (int s = 0; s < SHAPE_COUNT; s++) {
+            zmk_gesture_shape_normalize(templates[s], TEMPLATE_POINTS, reference,
+                                        RESAMPLED_POINTS);
+            if (zmk_gesture_shape_distance(candidate, reference, RESAMPLED_POINTS) <=
+                MAX_DISTANCE) {
+                false_matches++;
+                break;
+            }
+        }
+    }
+
+    printf("shapes: ");
+    for (int s = 0; s < SHAPE_COUNT; s++) {
+        printf("%s%s", names[s], s + 1 < SHAPE_COUNT ? ", " : "\n");
+    }
+    printf("accuracy: %zu / %d (%.1f%%)\n", correct, TRIALS, 100.0 * correct / TRIALS);
+    printf("worst distance of a correct match: %llu / 1000\n", (unsigned long long)worst_distance);
+    printf("random scribbles within %d / 1000 of a template: %zu / %d\n", MAX_DISTANCE,
+           false_matches, TRIALS);
+    printf("cost per gesture end: %.0f ns on this host (%d templates, %d points)\n", ns,
+           SHAPE_COUNT, RESAMPLED_POINTS);
+    printf("state: %zu bytes of path, %zu bytes of stack for two shapes\n",
+           sizeof(path), sizeof(candidate) + sizeof(reference));
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The ZMK Contributors
+# SPDX-License-Identifier: MIT
+
+"""Decode a `gesture trace dump` shell capture into a replayable motion trace.
+
+Reads the shell output (a log capture containing the dump is fine) from a file or
+stdin and prints one event per line:
+
+    <time_us> <kind> [<value>] [sync]
+
+where kind is REL_X, REL_Y, ACTIVATE or DEACTIVATE and time_us is absolute,
+starting at 0 with the first record. The record format is described in
+include/zmk/mouse_gesture_trace.h.
+"""
+
+import argparse
+import re
+import sys
+
+SUPPORTED_VERSION = 1
+
+KINDS = ("REL_X", "REL_Y", "ACTIVATE", "DEACTIVATE")
+KIND_MASK = 0x03
+SYNC_FLAG = 0x04
+
+HEADER = re.compile(r"gesture-trace v(\d+) (\d+)")
+FOOTER = "gesture-trace end"
+HEX_LINE = re.compile(r"^([0-9a-fA-F]{2})+$")
+
+
+def extract_dump(lines):
+    """Return the raw trace bytes of the last dump found in the capture."""
+    data = None
+    expected = 0
+
+    for line in lines:
+        line = line.strip()
+        header = HEADER.search(line)
+        if header:
+            version = int(header.group(1))
+            if version != SUPPORTED_VERSION:
+                raise ValueError(f"unsupported trace version {version}")
+            data = bytearray()
+            expected = int(header.group(2))
+        elif data is not None and FOOTER in line:
+            if len(data) != expected:
+                raise ValueError(f"truncated dump: {len(data)} of {expected} bytes")
+            return bytes(data)
+        elif data is not None and HEX_LINE.match(line):
+            data.extend(bytes.fromhex(line))
+
+    raise ValueError("no complete gesture trace dump found")
+
+
+def read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, pos
+        shift += 7
+
+
+def decode(data):
+    """Yield (time_us, kind, value, sync) tuples."""
+    pos = 0
+    time_us = 0
+    first = True
+
+    while pos < len(data):
+        delta, pos = read_varint(data, pos)
+        tag = data[pos]
+        pos += 1
+
+        kind = KINDS[tag & KIND_MASK]
+        value = None
+        if kind in ("REL_X", "REL_Y"):
+            zigzag, pos = read_varint(data, pos)
+            value = (zigzag >> 1) ^ -(zigzag & 1)
+
+        # The oldest record may refer to one that was already dropped
+        time_us = 0 if first else time_us + delta
+        first = False
+
+        yield time_us, kind, value, bool(tag & SYNC_FLAG)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", nargs="?", type=argparse.FileType("r"), default=sys.stdin,
+                        help="shell output containing `gesture trace dump` (default: stdin)")
+    args = parser.parse_args()
+
+    for time_us, kind, value, sync in decode(extract_dump(args.capture)):
+        fields = [str(time_us), kind]
+        if value is not None:
+            fields.append(str(value))
+        if sync:
+            fields.append("sync")
+        print(" ".join(fields))
+
+
+if __name__ == "__main__":
+    main()
@@ -9,9 +9,14 @@
 #include <zephyr/device.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
 #include <drivers/behavior.h>
 
 #include <zmk/behavior.h>
+#include <zmk/mouse_gesture.h>
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_TRACE)
+#include <zmk/mouse_gesture_trace.h>
+#endif
 #include <dt-bindings/zmk/mouse-gesture.h>
 
 enum toggle_mode {
@@ -30,21 +35,46 @@ struct behavior_mouse_gesture_config {
 };
 
 struct behavior_mouse_gesture_data {
-    bool is_active;
+    atomic_t is_active;  // Written from the keymap, read from the input path
 };
 
 static struct behavior_mouse_gesture_data global_gesture_state = {
-    .is_active = false
+    .is_active = ATOMIC_INIT(0)
 };
 
+static sys_slist_t gesture_listeners = SYS_SLIST_STATIC_INIT(&gesture_listeners);
+
 // Public function to get gesture state
 bool zmk_mouse_gesture_is_active(void) {
-    return global_gesture_state.is_active;
+    return atomic_get(&global_gesture_state.is_active) != 0;
+}
+
+void zmk_mouse_gesture_add_listener(struct zmk_mouse_gesture_listener *listener) {
+    sys_slist_append(&gesture_listeners, &listener->node);
+}
+
+// Update instance and global state, notifying listeners only on an actual edge
+static void set_gesture_active(struct behavior_mouse_gesture_data *data, bool active) {
+    atomic_set(&data->is_active, active);
+
+    bool was_active = atomic_set(&global_gesture_state.is_active, active) != 0;
+    if (was_active == active) {
+        return;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_TRACE)
+    zmk_mouse_gesture_trace_activation(active);
+#endif
+
+    struct zmk_mouse_gesture_listener *listener;
+    SYS_SLIST_FOR_EACH_CONTAINER(&gesture_listeners, listener, node) {
+        listener->state_changed(listener, active);
+    }
 }
 
 static int behavior_mouse_gesture_init(const struct device *dev) {
     struct behavior_mouse_gesture_data *data = dev->data;
-    data->is_active = false;
+    atomic_clear(&data->is_active);
 
     LOG_INF("Mouse gesture behavior initialized");
     return 0;
@@ -60,32 +90,27 @@ static int on_keymap_binding_pressed(struct zmk_behavior_binding *binding,
     switch (config->toggle_mode) {
         case TOGGLE_MODE_ON:
             LOG_DBG("Mouse gesture enabled");
-            data->is_active = true;
-            global_gesture_state.is_active = true;
+            set_gesture_active(data, true);
             break;
             
         case TOGGLE_MODE_OFF:
             LOG_DBG("Mouse gesture disabled");
-            data->is_active = false;
-            global_gesture_state.is_active = false;
+            set_gesture_active(data, false);
             break;
             
         case TOGGLE_MODE_MOMENTARY:
             LOG_DBG("Mouse gesture activated (momentary)");
-            data->is_active = true;
-            global_gesture_state.is_active = true;
+            set_gesture_active(data, true);
             break;
             
         case TOGGLE_MODE_FLIP:
         default:
-            if (global_gesture_state.is_active) {
+            if (zmk_mouse_gesture_is_active()) {
                 LOG_DBG("Mouse gesture toggled OFF");
-                data->is_active = false;
-                global_gesture_state.is_active = false;
+                set_gesture_active(data, false);
             } else {
                 LOG_DBG("Mouse gesture toggled ON");
-                data->is_active = true;
-                global_gesture_state.is_active = true;
+                set_gesture_active(data, true);
             }
             break;
     }
@@ -102,8 +127,7 @@ static int on_keymap_binding_released(struct zmk_behavior_binding *binding,
     // Only deactivate for momentary mode on release
     if (config->toggle_mode == TOGGLE_MODE_MOMENTARY) {
         LOG_DBG("Mouse gesture deactivated (momentary release)");
-        data->is_active = false;
-        global_gesture_state.is_active = false;
+        set_gesture_active(data, false);
     }
     // For other toggle modes, release events are ignored
 
@@ -113,11 +137,15 @@ static int on_keymap_binding_released(struct zmk_behavior_binding *binding,
 static const struct behavior_driver_api behavior_mouse_gesture_driver_api = {
     .binding_pressed = on_keymap_binding_pressed,
     .binding_released = on_keymap_binding_released,
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SPLIT_RECOGNITION)
+    // Mirror activation to the peripherals, where the recognizer runs
+    .locality = BEHAVIOR_LOCALITY_GLOBAL,
+#endif
 };
 
 #define MOUSE_GESTURE_INST(n)                                                  \
     static struct behavior_mouse_gesture_data behavior_mouse_gesture_data_##n = { \
-        .is_active = false,                                                    \
+        .is_active = ATOMIC_INIT(0),                                           \
     };                                                                         \
     static const struct behavior_mouse_gesture_config behavior_mouse_gesture_config_##n = { \
         .toggle_mode = DT_ENUM_IDX(DT_DRV_INST(n), toggle_mode),              \
@@ -12,7 +12,14 @@
 #include <zephyr/input/input.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/sys/util_macro.h>
+#include <zephyr/sys/math_extras.h>
 #include <drivers/input_processor.h>
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_PROFILE)
+#include <zephyr/timing/timing.h>
+#endif
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS)
+#include <zephyr/shell/shell.h>
+#endif
 #include <errno.h>
 #include <limits.h>
 #include <string.h>
@@ -23,6 +30,13 @@
 #include <zmk/behavior_queue.h>
 #include <drivers/behavior.h>
 #include <zmk/mouse_gesture.h>
+#include <zmk/mouse_gesture_quantizer.h>
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_TRACE)
+#include <zmk/mouse_gesture_trace.h>
+#endif
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES)
+#include <zmk/mouse_gesture_shape.h>
+#endif
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
@@ -33,316 +47,1675 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif
 
+#define EXECUTION_QUEUE_SIZE CONFIG_ZMK_MOUSE_GESTURE_EXECUTION_QUEUE_SIZE
+
+// Map a devicetree direction constant to its sector, as an integer constant expression
+#define GESTURE_CODE_TO_SECTOR(code)                                                               \
+    ((code) >= GESTURE_16WAY(0) ? ((code) & 0xF)                                                   \
+     : (code) == GESTURE_UP         ? 0                                                            \
+     : (code) == GESTURE_UP_RIGHT   ? 2                                                            \
+     : (code) == GESTURE_RIGHT      ? 4                                                            \
+     : (code) == GESTURE_DOWN_RIGHT ? 6                                                            \
+     : (code) == GESTURE_DOWN       ? 8                                                            \
+     : (code) == GESTURE_DOWN_LEFT  ? 10                                                           \
+     : (code) == GESTURE_LEFT       ? 12                                                           \
+     : (code) == GESTURE_UP_LEFT    ? 14                                                           \
+                                    : GESTURE_SECTOR_NONE)
+
+/*
+ * Split recognition: the peripheral recognizes gestures next to its sensor and reports
+ * each match as a single MSC event through the split input transport. The central's
+ * instance of the same processor turns that event back into an execution of its own
+ * copy of the pattern, so both halves must share the pattern children.
+ */
+#define GESTURE_SPLIT_PERIPHERAL                                                                   \
+    (IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SPLIT_RECOGNITION) &&                                    \
+     !IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL))
+#define GESTURE_SPLIT_CENTRAL                                                                      \
+    (IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SPLIT_RECOGNITION) &&                                    \
+     IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL))
+#define GESTURE_SPLIT_EVENT_CODE INPUT_MSC_RAW
+#define GESTURE_SPLIT_EVENT_TAG 0x4D470000  // "MG" in the upper half, pattern index below
+#define GESTURE_SPLIT_TAG_MASK 0xFFFF0000
+
+/*
+ * Table sizes derived from the devicetree, as preprocessor-friendly expressions over
+ * every enabled instance: the most patterns in one instance and the longest pattern.
+ * Masks and packed sequences are only as wide as these need.
+ */
+#define GESTURE_PATTERN_LIMIT 32  // Widest gesture_mask_t
+#define GESTURE_STROKE_LIMIT 8    // Nibbles in the widest gesture_sequence_t
+
+#define GESTURE_CHILD_ONE(n) 1 +
+#define GESTURE_NODE_PATTERN_COUNT(node) (DT_FOREACH_CHILD(node, GESTURE_CHILD_ONE) 0)
+#define GESTURE_NODE_HAS_PATTERNS(node, count) (GESTURE_NODE_PATTERN_COUNT(node) > (count)) ||
+#define GESTURE_ANY_HAS_PATTERNS(count, _)                                                         \
+    (DT_FOREACH_STATUS_OKAY_VARGS(DT_DRV_COMPAT, GESTURE_NODE_HAS_PATTERNS, count) 0)
+#define GESTURE_MOST_PATTERNS (LISTIFY(GESTURE_PATTERN_LIMIT, GESTURE_ANY_HAS_PATTERNS, (+), _))
+
+// Strokes in a child's direction pattern, 0 for shape patterns
+#define GESTURE_PATTERN_LEN(n) DT_PROP_LEN_OR(n, pattern, 0)
+#define GESTURE_CHILD_LONGER(n, len) (GESTURE_PATTERN_LEN(n) > (len)) ||
+#define GESTURE_NODE_HAS_LONGER(node, len) DT_FOREACH_CHILD_VARGS(node, GESTURE_CHILD_LONGER, len)
+#define GESTURE_ANY_LONGER(len, _)                                                                 \
+    (DT_FOREACH_STATUS_OKAY_VARGS(DT_DRV_COMPAT, GESTURE_NODE_HAS_LONGER, len) 0)
+#define GESTURE_LONGEST_PATTERN (LISTIFY(GESTURE_STROKE_LIMIT, GESTURE_ANY_LONGER, (+), _))
+
+// One bit per pattern, indexed by the pattern's child index in the devicetree
+#if GESTURE_MOST_PATTERNS <= 8
+typedef uint8_t gesture_mask_t;
+#elif GESTURE_MOST_PATTERNS <= 16
+typedef uint16_t gesture_mask_t;
+#else
+typedef uint32_t gesture_mask_t;
+#endif
+
+// Tolerant matching may accept a sequence with up to two extra strokes
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_TOLERANT_MATCHING)
+#define GESTURE_MAX_EDITS 2
+#define GESTURE_SEQUENCE_SLACK GESTURE_MAX_EDITS
+#else
+#define GESTURE_SEQUENCE_SLACK 0
+#endif
+
+// Directions of a sequence, one nibble per stroke with the first stroke lowest
+#if GESTURE_LONGEST_PATTERN + GESTURE_SEQUENCE_SLACK <= 2
+typedef uint8_t gesture_sequence_t;
+#define MAX_GESTURE_SEQUENCE_LENGTH 2
+#elif GESTURE_LONGEST_PATTERN + GESTURE_SEQUENCE_SLACK <= 4
+typedef uint16_t gesture_sequence_t;
+#define MAX_GESTURE_SEQUENCE_LENGTH 4
+#else
+typedef uint32_t gesture_sequence_t;
 #define MAX_GESTURE_SEQUENCE_LENGTH 8
-#define MAX_GESTURE_PATTERNS 16
-#define MAX_DEFERRED_BINDINGS 8
+#endif
+
+#define MAX_GESTURE_PATTERNS GESTURE_MOST_PATTERNS
+#define GESTURE_SEQUENCE_AT(sequence, pos) (((sequence) >> (4 * (pos))) & 0xF)
+
+BUILD_ASSERT(MAX_GESTURE_PATTERNS <= sizeof(gesture_mask_t) * 8,
+             "gesture_mask_t is too narrow for MAX_GESTURE_PATTERNS");
+BUILD_ASSERT(MAX_GESTURE_SEQUENCE_LENGTH <= sizeof(gesture_sequence_t) * 2,
+             "gesture_sequence_t is too narrow for MAX_GESTURE_SEQUENCE_LENGTH");
 
-// Gesture pattern definition (from behavior)
+// Gesture pattern definition, generated from the devicetree into flash
 struct gesture_pattern {
-    size_t bindings_len;
-    struct zmk_behavior_binding *bindings;
-    size_t pattern_len;
-    uint8_t pattern[];  // Variable length array at end
+    const struct zmk_behavior_binding *bindings;
+    gesture_sequence_t sequence;  // Packed like the recognized sequence
+    uint8_t bindings_len;
+    uint8_t pattern_len;
+    uint8_t index;  // Child index, identifies the pattern across split halves
+    bool repeat;    // Re-trigger on continued movement in the final direction
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES)
+    const int32_t *shape;  // Template points as interleaved X/Y, NULL for direction patterns
+    uint8_t shape_len;     // Template points
+#endif
+};
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES)
+#define GESTURE_SHAPE_POINTS CONFIG_ZMK_MOUSE_GESTURE_SHAPE_POINTS
+#define GESTURE_PATH_POINTS CONFIG_ZMK_MOUSE_GESTURE_SHAPE_PATH_POINTS
+#endif
+
+/*
+ * Prefix matcher generated at build time from the pattern children.
+ *
+ * Each matcher state is the set of patterns whose prefix equals the current
+ * sequence. Appending a direction is a single AND with step_masks[position][direction];
+ * an empty result is a dead end, and any bit left in length_masks[new length] is a
+ * complete match.
+ */
+struct gesture_matcher {
+    gesture_mask_t step_masks[MAX_GESTURE_SEQUENCE_LENGTH][GESTURE_DIRECTION_CODES];
+    gesture_mask_t length_masks[MAX_GESTURE_SEQUENCE_LENGTH + 1];
+    gesture_mask_t all_patterns;
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_TOLERANT_MATCHING)
+    // Patterns whose stroke at a position is a neighbouring direction (substitution)
+    gesture_mask_t near_masks[MAX_GESTURE_SEQUENCE_LENGTH][GESTURE_DIRECTION_CODES];
+    // Patterns that tolerate an extra direction after a position's strokes (insertion)
+    gesture_mask_t insert_masks[MAX_GESTURE_SEQUENCE_LENGTH][GESTURE_DIRECTION_CODES];
+#endif
+};
+
+struct input_processor_mouse_gesture_config {
+    uint32_t stroke_size;
+    uint32_t movement_threshold;
+    uint32_t decay_half_life_ms;  // Half-life of the stroke accumulators, 0 never decays
+    uint32_t flick_velocity;      // Stroke speed in counts/s that gets the shortest stroke
+    uint32_t flick_stroke_size;   // Stroke size at and above flick_velocity
+    uint32_t gesture_cooldown_ms;  // Cooldown period between gestures
+    struct gesture_quantizer quantizer;
+    bool frame_sync;  // Recognize once per input report instead of once per event
+    uint32_t decimation_us;    // Shortest time between recognition passes, 0 for every event
+    uint32_t loop_guard_rate;  // Sustained passes per second that trip the loop guard
+    bool consume_motion;  // Keep X/Y motion from the host while gestures are active
+    bool replay_motion;   // Report the consumed net motion if no gesture matched
+    const struct gesture_pattern *const *patterns;  // Array of pointers to patterns
+    size_t pattern_count;
+    const struct gesture_matcher *matcher;
+    uint32_t press_spacing_ms;  // Delay after each binding's release before the next press
+    uint32_t hold_time_ms;      // Delay between each binding's press and release
+    uint32_t commit_timeout_ms;  // How long an ambiguous match waits for a longer pattern
+    uint8_t max_edits;           // Edits a tolerant match may need, 0 matches exactly
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES)
+    gesture_mask_t shape_patterns;  // Patterns recognized by shape at deactivation
+    uint16_t shape_max_distance;    // Largest accepted shape distance, in 1/1000 of the shape
+#endif
+    uint32_t repeat_rate;        // Sustained repeats per second of a repeat pattern
+    uint32_t repeat_burst;       // Repeats allowed back to back before the rate applies
+};
+
+// Token bucket fill is kept in thousandths of a token, so refilling is ms * tokens/s
+#define GESTURE_TOKEN 1000
+
+struct gesture_token_bucket {
+    uint32_t tokens;       // Fill, in 1/GESTURE_TOKEN
+    int64_t refill_time;   // When the bucket was last refilled
+};
+
+// Matched gesture waiting for the work queue
+struct gesture_execution_request {
+    const struct gesture_pattern *pattern;
+    const struct device *input;  // Input device whose motion matched
+    int64_t timestamp;
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_MEASURE_LATENCY) || IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS)
+    uint32_t match_cycles;  // Cycle counter at match time
+#endif
+};
+
+/*
+ * Deferred execution ring. Producers are the recognizer owners of the sources and take
+ * a short lock to fill a slot; the work handler is the only consumer and reads without
+ * it, so tail has a single writer.
+ */
+struct deferred_gesture_queue {
+    struct k_work work;
+    const struct device *dev;
+    struct gesture_execution_request requests[EXECUTION_QUEUE_SIZE];
+    struct k_spinlock lock;  // Serializes producers
+    atomic_t head;       // Next slot to fill, advanced by the producer
+    atomic_t tail;       // Next slot to execute, advanced by the consumer
+    atomic_t overflows;  // Matches dropped because the ring was full
+};
+
+// Sample code of an event that only ends a report (frame-sync)
+#define GESTURE_SAMPLE_SYNC UINT16_MAX
+
+// reset_requested bits: start over, and first commit what the ended activation left pending
+#define GESTURE_RESET BIT(0)
+#define GESTURE_RESET_COMMIT BIT(1)
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+#define GESTURE_SAMPLE_RING_SIZE CONFIG_ZMK_MOUSE_GESTURE_SAMPLE_RING_SIZE
+
+BUILD_ASSERT(IS_POWER_OF_TWO(GESTURE_SAMPLE_RING_SIZE),
+             "CONFIG_ZMK_MOUSE_GESTURE_SAMPLE_RING_SIZE must be a power of two");
+
+// Event handed from the input handler to the recognizer thread
+struct gesture_sample {
+    struct gesture_source *source;
+    int64_t timestamp;  // When the event was reported
+    uint32_t generation;  // Activation the event belongs to, see gesture_generation
+    int32_t value;
+    uint16_t code;      // INPUT_REL_X, INPUT_REL_Y or GESTURE_SAMPLE_SYNC
+    bool sync;
+};
+
+/*
+ * Sample ring. The input thread is the only producer and the recognizer thread the only
+ * consumer, so head and tail each have a single writer and neither side waits. Indices
+ * run freely as uint32_t; the power-of-two size keeps slots consistent across the wrap.
+ */
+struct gesture_sample_ring {
+    struct gesture_sample samples[GESTURE_SAMPLE_RING_SIZE];
+    atomic_t head;       // Next slot to fill, advanced by the producer
+    atomic_t tail;       // Next slot to recognize, advanced by the consumer
+    atomic_t overflows;  // Samples dropped because the ring was full
+    atomic_val_t overflows_reported;  // Last overflow count logged by the consumer
+};
+
+// Wakes the recognizer thread, shared by all processor instances
+static K_SEM_DEFINE(gesture_sample_sem, 0, 1);
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS)
+#define GESTURE_HISTOGRAM_BUCKETS 12
+
+// Bucket i counts samples in [2^i, 2^(i+1)), bucket 0 also takes 0 and the last one is open
+struct gesture_histogram {
+    atomic_t buckets[GESTURE_HISTOGRAM_BUCKETS];
+};
+
+struct gesture_stats {
+    atomic_t events;                 // REL X/Y events seen while active
+    atomic_t below_threshold;        // Events (or frames) ignored below movement-threshold
+    atomic_t handoffs;               // Events left to a concurrent recognizer owner
+    atomic_t cooldown_rejects;       // Matches held back or dropped during the gesture cooldown
+    atomic_t accumulator_overflows;  // -EOVERFLOW resets in accumulate_movement_safe()
+    atomic_t sequence_overflows;     // Sequences cleared at MAX_GESTURE_SEQUENCE_LENGTH
+    atomic_t loop_guard_trips;       // Sequences cleared by the loop guard
+    atomic_t decimated;              // Events merged into a later recognition pass
+    atomic_t submit_failures;        // Failed work queue submissions
+    atomic_t split_report_failures;  // Gestures the peripheral could not send to the central
+    atomic_t repeats;                // Re-triggers of repeat patterns
+    atomic_t repeat_throttled;       // Re-triggers dropped by the repeat token bucket
+    atomic_t motion_x;               // Net motion drained by the recognizer
+    atomic_t motion_y;
+    atomic_t pattern_hits[MAX_GESTURE_PATTERNS];
+    struct gesture_histogram stroke_ms;   // Time to complete one stroke
+    struct gesture_histogram latency_us;  // Match to the first press
+};
+
+#define GESTURE_STAT_INC(data, name) atomic_inc(&(data)->stats.name)
+#define GESTURE_STAT_ADD(data, name, value) atomic_add(&(data)->stats.name, value)
+#else
+#define GESTURE_STAT_INC(data, name) ((void)(data))
+#define GESTURE_STAT_ADD(data, name, value) ((void)(data))
+#endif
+
+#define GESTURE_SOURCES CONFIG_ZMK_MOUSE_GESTURE_SOURCES
+
+/*
+ * Recognizer state of one input device. Each source is single-writer: only the thread
+ * that owns its `recognizer` touches the fields below it. Producers never block; they
+ * post their delta into the pending accumulators and the current owner drains them
+ * before giving up ownership. Sources never share a field, so two pointing devices
+ * feeding one processor recognize independently.
+ */
+struct gesture_source {
+    const struct device *dev;   // Processor the source belongs to
+    atomic_ptr_t input;         // Input device that claimed this source, NULL while free
+    atomic_t reset_requested;   // GESTURE_RESET bits set on activation edges, for the owner
+    atomic_t pending_x;         // Deltas posted by producers, not yet recognized
+    atomic_t pending_y;
+    atomic_t frame_x;           // Deltas of the current report, posted on its sync (frame-sync)
+    atomic_t frame_y;
+    atomic_t recognizer;        // 1 while a thread owns the recognizer state
+    atomic_t commit_requested;  // Set when the commit timeout expires
+    struct k_work_delayable commit_work;
+    atomic_t next_pass;         // Cycle count before which motion is only merged (decimation)
+    struct k_work_delayable flush_work;  // Recognizes merged motion once movement stops
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+    atomic_t flush_requested;   // Set by flush_work for the recognizer thread
+#endif
+    atomic_t consumed_x;        // Net motion consumed during the current activation
+    atomic_t consumed_y;
+    atomic_t replay_x;          // Consumed motion of an unmatched activation, for replay_work
+    atomic_t replay_y;
+    atomic_t matched;           // Set once a gesture fires during the current activation
+#if GESTURE_SPLIT_CENTRAL
+    atomic_t remote_matches;    // Patterns matched by the split peripheral, for the owner
+#endif
+    int32_t acc_x;
+    int32_t acc_y;
+    int64_t stroke_start;       // When the current stroke started accumulating
+    int64_t decay_time;         // Time up to which the accumulators have been decayed
+    gesture_sequence_t sequence;  // Directions so far, packed like gesture_pattern
+    uint8_t sequence_len;
+    gesture_mask_t candidates;  // Patterns still reachable from the current sequence
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_TOLERANT_MATCHING)
+    // Bitap state: patterns whose first j strokes align with the sequence in <= e edits
+    gesture_mask_t alignments[GESTURE_MAX_EDITS + 1][MAX_GESTURE_SEQUENCE_LENGTH + 1];
+#endif
+    gesture_mask_t pending_match;  // Complete match held back for a longer pattern
+    int64_t pending_deadline;   // When pending_match is committed
+    const struct gesture_pattern *repeat;  // Repeat pattern re-triggered by further strokes
+    uint8_t repeat_direction;   // Final direction of the repeat pattern
+    struct gesture_token_bucket repeat_bucket;  // Limits re-triggers to repeat-rate
+    int64_t last_gesture_time;  // Timestamp of last gesture execution
+    struct gesture_token_bucket loop_bucket;    // Recognition passes left before the loop guard
+    bool loop_tripped;          // Loop guard is dropping passes until a token is available
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES)
+    int32_t path[2 * GESTURE_PATH_POINTS];  // Recorded positions, interleaved X/Y
+    uint16_t path_len;
+    uint32_t path_spacing;      // Movement between recorded positions, doubled when full
+    int32_t path_x;             // Position relative to the activation point
+    int32_t path_y;
+#endif
+};
+
+struct input_processor_mouse_gesture_data {
+    const struct device *dev;
+    atomic_t active;            // Mirrors zmk_mouse_gesture_is_active() via edge callbacks
+    struct zmk_mouse_gesture_listener listener;
+    struct gesture_source sources[GESTURE_SOURCES];
+    struct deferred_gesture_queue deferred_queue;  // Pending gesture executions
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+    struct gesture_sample_ring sample_ring;  // Events waiting for the recognizer thread
+    atomic_t generation;        // Activation edges so far, odd while active
+    uint32_t recognized_generation;  // Edges the recognizer thread has applied
+#endif
+    struct k_work replay_work;
+    uint32_t decimation_cycles;  // decimation_us in cycles of k_cycle_get_32()
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS)
+    struct gesture_stats stats;
+#endif
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_PROFILE)
+    atomic_t profile_events;    // Events measured in the current interval
+    atomic_t profile_cycles;    // Handler cycles spent in the current interval
+    atomic_t profile_max;       // Slowest single event in the current interval
+#endif
+};
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_WORK_QUEUE_DEDICATED)
+K_THREAD_STACK_DEFINE(gesture_work_q_stack, CONFIG_ZMK_MOUSE_GESTURE_WORK_QUEUE_STACK_SIZE);
+static struct k_work_q gesture_work_q;
+
+static int gesture_work_q_init(void) {
+    k_work_queue_start(&gesture_work_q, gesture_work_q_stack,
+                       K_THREAD_STACK_SIZEOF(gesture_work_q_stack),
+                       CONFIG_ZMK_MOUSE_GESTURE_WORK_QUEUE_PRIORITY, NULL);
+    k_thread_name_set(&gesture_work_q.thread, "mouse_gesture_wq");
+    return 0;
+}
+
+// Started before the processor instances so it is ready for their first match
+SYS_INIT(gesture_work_q_init, POST_KERNEL, 0);
+
+#define GESTURE_WORK_SUBMIT(work) k_work_submit_to_queue(&gesture_work_q, work)
+#define GESTURE_WORK_SCHEDULE(dwork, delay) k_work_schedule_for_queue(&gesture_work_q, dwork, delay)
+#define GESTURE_WORK_RESCHEDULE(dwork, delay) k_work_reschedule_for_queue(&gesture_work_q, dwork, delay)
+#else
+#define GESTURE_WORK_SUBMIT(work) k_work_submit(work)
+#define GESTURE_WORK_SCHEDULE(dwork, delay) k_work_schedule(dwork, delay)
+#define GESTURE_WORK_RESCHEDULE(dwork, delay) k_work_reschedule(dwork, delay)
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS)
+static void histogram_add(struct gesture_histogram *histogram, uint32_t value) {
+    size_t bucket = value == 0 ? 0 : 31 - u32_count_leading_zeros(value);
+    atomic_inc(&histogram->buckets[MIN(bucket, GESTURE_HISTOGRAM_BUCKETS - 1)]);
+}
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_MEASURE_LATENCY) || IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS)
+// Record the time from pattern match to the gesture's first press
+static void record_execution_latency(const struct device *dev,
+                                     const struct gesture_execution_request *request) {
+    uint32_t latency_us = k_cyc_to_us_floor32(k_cycle_get_32() - request->match_cycles);
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_MEASURE_LATENCY)
+    LOG_INF("Gesture match-to-press latency: %u us", latency_us);
+#endif
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS)
+    struct input_processor_mouse_gesture_data *data = dev->data;
+    histogram_add(&data->stats.latency_us, latency_us);
+#endif
+}
+#endif
+
+static void execute_gesture(const struct device *dev, const struct gesture_execution_request *request) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+    const struct gesture_pattern *pattern = request->pattern;
+    struct zmk_behavior_binding_event event = {
+        .position = INT32_MAX,
+        .timestamp = request->timestamp,
+#if IS_ENABLED(CONFIG_ZMK_SPLIT)
+        .source = ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL,
+#endif
+    };
+
+    LOG_DBG("Executing deferred gesture with %d bindings", pattern->bindings_len);
+
+#if GESTURE_SPLIT_PERIPHERAL
+    // The central executes the bindings; only the pattern index crosses the split link,
+    // reported through the sensor so the split input forwarder picks it up. Never block
+    // the work queue on a full input queue, a lost gesture beats a stalled keyboard.
+    struct input_processor_mouse_gesture_data *data = dev->data;
+    int ret = input_report(request->input, INPUT_EV_MSC, GESTURE_SPLIT_EVENT_CODE,
+                           GESTURE_SPLIT_EVENT_TAG | pattern->index, true, K_NO_WAIT);
+    if (ret < 0) {
+        LOG_ERR("Failed to send gesture %d to the central: %d", pattern->index, ret);
+        GESTURE_STAT_INC(data, split_report_failures);
+        return;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_MEASURE_LATENCY) || IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS)
+    record_execution_latency(dev, request);
+#endif
+    return;
+#endif
+
+    // Bindings always go through the behavior queue, so a gesture never overtakes the
+    // releases an earlier one still has queued. The queue invokes items inline while it is
+    // idle, and a zero hold time and the last release set no timer, so tap-style gestures
+    // still fire right here.
+    for (size_t k = 0; k < pattern->bindings_len; k++) {
+        bool last = k + 1 == pattern->bindings_len;
+
+        LOG_DBG("Executing deferred binding [%zu/%d]", k + 1, pattern->bindings_len);
+
+        int ret = zmk_behavior_queue_add(&event, pattern->bindings[k], true, config->hold_time_ms);
+        if (ret < 0) {
+            LOG_ERR("Failed to queue deferred press event [%zu]: %d", k, ret);
+            continue;
+        }
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_MEASURE_LATENCY) || IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS)
+        // Pressed by now, unless an earlier gesture's bindings still hold up the behavior queue
+        if (k == 0) {
+            record_execution_latency(dev, request);
+        }
+#endif
+
+        ret = zmk_behavior_queue_add(&event, pattern->bindings[k], false,
+                                     last ? 0 : config->press_spacing_ms);
+        if (ret < 0) {
+            LOG_ERR("Failed to queue deferred release event [%zu]: %d", k, ret);
+        }
+    }
+}
+
+// Work queue handler for deferred gesture execution, drains every pending request
+static void deferred_gesture_work_handler(struct k_work *work) {
+    struct deferred_gesture_queue *queue = CONTAINER_OF(work, struct deferred_gesture_queue, work);
+    atomic_val_t tail = atomic_get(&queue->tail);
+
+    while (tail != atomic_get(&queue->head)) {
+        execute_gesture(queue->dev, &queue->requests[tail % EXECUTION_QUEUE_SIZE]);
+        tail++;
+        atomic_set(&queue->tail, tail);
+    }
+
+    LOG_DBG("Deferred gesture execution completed");
+}
+
+// Schedule gesture execution via work queue (completely asynchronous)
+static void schedule_gesture_execution(const struct device *dev, struct gesture_source *source,
+                                       const struct gesture_pattern *pattern) {
+    if (!pattern || pattern->bindings_len == 0) {
+        return;
+    }
+
+    struct input_processor_mouse_gesture_data *data = dev->data;
+    struct deferred_gesture_queue *queue = &data->deferred_queue;
+    k_spinlock_key_t key = k_spin_lock(&queue->lock);
+    atomic_val_t head = atomic_get(&queue->head);
+
+    if (head - atomic_get(&queue->tail) >= EXECUTION_QUEUE_SIZE) {
+        k_spin_unlock(&queue->lock, key);
+        atomic_val_t overflows = atomic_inc(&queue->overflows) + 1;
+        LOG_WRN("Gesture execution queue full, dropping match (%ld dropped so far)",
+                (long)overflows);
+        return;
+    }
+
+    struct gesture_execution_request *request = &queue->requests[head % EXECUTION_QUEUE_SIZE];
+    request->pattern = pattern;
+    request->input = atomic_ptr_get(&source->input);
+    request->timestamp = k_uptime_get();
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_MEASURE_LATENCY) || IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS)
+    request->match_cycles = k_cycle_get_32();
+#endif
+
+    // Publish the slot only after it is fully written
+    atomic_set(&queue->head, head + 1);
+    k_spin_unlock(&queue->lock, key);
+
+    // Always the system work queue, even with the dedicated one: behaviors run there, and
+    // the behavior queue presses the first binding inline in the caller's context
+    int ret = k_work_submit(&queue->work);
+    if (ret < 0) {
+        GESTURE_STAT_INC(data, submit_failures);
+        LOG_ERR("Failed to submit gesture work: %d", ret);
+    } else {
+        LOG_DBG("Gesture execution scheduled successfully");
+    }
+}
+
+// Restart matching from an empty sequence (called by the recognizer owner)
+static void reset_sequence_owned(const struct device *dev, struct gesture_source *source) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+
+    source->sequence = 0;
+    source->sequence_len = 0;
+    source->candidates = config->matcher->all_patterns;
+    source->pending_match = 0;
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_TOLERANT_MATCHING)
+    memset(source->alignments, 0, sizeof(source->alignments));
+    for (int e = 0; e <= config->max_edits; e++) {
+        source->alignments[e][0] = config->matcher->all_patterns;
+    }
+#endif
+}
+
+// Execute a pattern and start over (called by the recognizer owner)
+static void fire_pattern_owned(const struct device *dev, struct gesture_source *source,
+                               size_t index) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+    struct input_processor_mouse_gesture_data *data = dev->data;
+
+    LOG_INF("Gesture pattern matched: %zu", index);
+    GESTURE_STAT_INC(data, pattern_hits[index]);
+    atomic_set(&source->matched, 1);
+
+    source->last_gesture_time = k_uptime_get();
+    reset_sequence_owned(dev, source);
+
+    schedule_gesture_execution(dev, source, config->patterns[index]);
+}
+
+// Execute the lowest-indexed pattern of a match set (called by the recognizer owner)
+static void fire_match_owned(const struct device *dev, struct gesture_source *source,
+                             gesture_mask_t match) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+
+    // Lowest child index wins, same as the declaration order in the devicetree
+    size_t index = u32_count_trailing_zeros(match);
+    const struct gesture_pattern *pattern = config->patterns[index];
+
+    // The matcher tables and the packed pattern are generated separately; one compare
+    // catches any disagreement in debug builds
+    __ASSERT(config->max_edits > 0 || (pattern->pattern_len == source->sequence_len &&
+                                       pattern->sequence == source->sequence),
+             "Matched pattern %zu differs from sequence 0x%x", index, source->sequence);
+
+    // Further strokes in the pattern's final direction re-trigger it until the direction changes
+    source->repeat = pattern->repeat ? pattern : NULL;
+    source->repeat_direction = GESTURE_SEQUENCE_AT(source->sequence, source->sequence_len - 1);
+
+    fire_pattern_owned(dev, source, index);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES)
+// Start a new path at the activation point (called by the recognizer owner)
+static void reset_path_owned(const struct device *dev, struct gesture_source *source) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+
+    source->path_x = 0;
+    source->path_y = 0;
+    source->path[0] = 0;
+    source->path[1] = 0;
+    source->path_len = 1;
+    source->path_spacing = MAX(config->stroke_size / 8, 1);
+}
+
+// Follow the pointer, keeping a position every path_spacing of movement. A full buffer
+// drops every other position and doubles the spacing, so any path fits in bounded memory.
+static void record_path_owned(const struct device *dev, struct gesture_source *source, int32_t dx,
+                              int32_t dy) {
+    source->path_x += dx;
+    source->path_y += dy;
+
+    const int32_t *last = &source->path[2 * (source->path_len - 1)];
+    uint32_t moved = ABS(source->path_x - last[0]) + ABS(source->path_y - last[1]);
+    if (moved < source->path_spacing) {
+        return;
+    }
+
+    if (source->path_len == GESTURE_PATH_POINTS) {
+        for (size_t i = 1; i < GESTURE_PATH_POINTS / 2; i++) {
+            source->path[2 * i] = source->path[4 * i];
+            source->path[2 * i + 1] = source->path[4 * i + 1];
+        }
+        source->path_len = GESTURE_PATH_POINTS / 2;
+        source->path_spacing *= 2;
+    }
+
+    source->path[2 * source->path_len] = source->path_x;
+    source->path[2 * source->path_len + 1] = source->path_y;
+    source->path_len++;
+}
+
+// Compare the path of an activation that matched nothing against the shape templates
+// (called by the recognizer owner)
+static void recognize_shape_owned(const struct device *dev, struct gesture_source *source) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+    struct zmk_gesture_shape_point candidate[GESTURE_SHAPE_POINTS];
+    struct zmk_gesture_shape_point reference[GESTURE_SHAPE_POINTS];
+
+    // Shapes are only tried when no direction pattern claimed the activation
+    if (config->shape_patterns == 0 || atomic_get(&source->matched)) {
+        return;
+    }
+
+    if (zmk_gesture_shape_normalize(source->path, source->path_len, candidate,
+                                    GESTURE_SHAPE_POINTS) < 0) {
+        LOG_DBG("Path too short for shape recognition");
+        return;
+    }
+
+    size_t best = 0;
+    uint32_t best_distance = UINT32_MAX;
+
+    // Templates are normalized on the fly instead of being kept in RAM
+    for (gesture_mask_t shapes = config->shape_patterns; shapes != 0; shapes &= shapes - 1) {
+        size_t index = u32_count_trailing_zeros(shapes);
+        const struct gesture_pattern *pattern = config->patterns[index];
+
+        if (zmk_gesture_shape_normalize(pattern->shape, pattern->shape_len, reference,
+                                        GESTURE_SHAPE_POINTS) < 0) {
+            continue;
+        }
+
+        // Strictly closer wins, so ties go to the lowest child index
+        uint32_t distance = zmk_gesture_shape_distance(candidate, reference, GESTURE_SHAPE_POINTS);
+        LOG_DBG("Shape pattern %zu distance %u", index, distance);
+        if (distance < best_distance) {
+            best_distance = distance;
+            best = index;
+        }
+    }
+
+    if (best_distance > config->shape_max_distance) {
+        LOG_DBG("No shape within %u", config->shape_max_distance);
+        return;
+    }
+
+    source->repeat = NULL;
+    fire_pattern_owned(dev, source, best);
+}
+#endif
+
+static void fill_bucket(struct gesture_token_bucket *bucket, uint32_t burst, int64_t now) {
+    bucket->tokens = burst * GESTURE_TOKEN;
+    bucket->refill_time = now;
+}
+
+// Refill for the time since the last attempt, capped at burst tokens, then take one token
+static bool take_token(struct gesture_token_bucket *bucket, uint32_t burst, uint32_t rate,
+                       int64_t now) {
+    uint32_t capacity = burst * GESTURE_TOKEN;
+    // A pass on the current time may precede one recognizing an older queued sample
+    int64_t elapsed = MAX(now - bucket->refill_time, 0);
+
+    if (elapsed >= capacity / rate) {
+        bucket->tokens = capacity;
+    } else {
+        bucket->tokens = MIN(capacity, bucket->tokens + (uint32_t)elapsed * rate);
+    }
+    bucket->refill_time = MAX(now, bucket->refill_time);
+
+    if (bucket->tokens < GESTURE_TOKEN) {
+        return false;
+    }
+
+    bucket->tokens -= GESTURE_TOKEN;
+    return true;
+}
+
+// Re-trigger the repeat pattern if the token bucket allows it (called by the recognizer owner)
+static void repeat_gesture_owned(const struct device *dev, struct gesture_source *source,
+                                 int64_t current_time) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+    struct input_processor_mouse_gesture_data *data = dev->data;
+
+    if (!take_token(&source->repeat_bucket, config->repeat_burst, config->repeat_rate,
+                    current_time)) {
+        LOG_DBG("Repeat rate limit reached, dropping repeat");
+        GESTURE_STAT_INC(data, repeat_throttled);
+        return;
+    }
+
+    source->last_gesture_time = current_time;
+    GESTURE_STAT_INC(data, repeats);
+    LOG_DBG("Repeating gesture in direction %d", source->repeat_direction);
+
+    schedule_gesture_execution(dev, source, source->repeat);
+}
+
+#if GESTURE_SPLIT_CENTRAL
+// Execute patterns matched by the split peripheral (called by the recognizer owner)
+static void execute_remote_matches_owned(const struct device *dev, struct gesture_source *source,
+                                         gesture_mask_t matches) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+    struct input_processor_mouse_gesture_data *data = dev->data;
+
+    for (; matches != 0; matches &= matches - 1) {
+        size_t index = u32_count_trailing_zeros(matches);
+
+        LOG_INF("Gesture pattern matched on peripheral: %zu", index);
+        GESTURE_STAT_INC(data, pattern_hits[index]);
+        atomic_set(&source->matched, 1);
+        schedule_gesture_execution(dev, source, config->patterns[index]);
+    }
+}
+#endif
+
+// Fire the match held back for a longer pattern, if it is due (called by the recognizer owner)
+static void commit_pending_match_owned(const struct device *dev, struct gesture_source *source,
+                                       bool force) {
+    if (source->pending_match == 0) {
+        return;
+    }
+
+    // A timer armed for an earlier prefix may fire after the match was re-armed
+    if (!force && k_uptime_get() < source->pending_deadline) {
+        return;
+    }
+
+    LOG_DBG("Committing ambiguous gesture match");
+    fire_match_owned(dev, source, source->pending_match);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_TOLERANT_MATCHING)
+/*
+ * Bit-parallel tolerant step, bitap with patterns as the parallel dimension. Row e of
+ * the state holds, per pattern position j, the patterns whose first j strokes align
+ * with the whole sequence using at most e edits; an edit is a stroke replaced by a
+ * neighbouring direction or an extra neighbouring direction between two strokes. Each
+ * new direction costs a few word operations per (e, j) cell, whatever the pattern count.
+ *
+ * Stores in *complete the patterns completed with the fewest edits, so ties go to the
+ * closest match and then the lowest child index. Returns those plus the patterns that
+ * are still only partly aligned; a pattern completed with more edits is not worth
+ * waiting for.
+ */
+static gesture_mask_t advance_tolerant_owned(const struct device *dev,
+                                             struct gesture_source *source, uint8_t direction,
+                                             gesture_mask_t *complete) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+    const struct gesture_matcher *matcher = config->matcher;
+    gesture_mask_t (*rows)[MAX_GESTURE_SEQUENCE_LENGTH + 1] = source->alignments;
+    gesture_mask_t alive = 0;
+    gesture_mask_t completed_any = 0;
+
+    *complete = 0;
+
+    // Rows are updated from the most edits down, so row e - 1 still holds the old state
+    for (int e = config->max_edits; e >= 0; e--) {
+        gesture_mask_t next[MAX_GESTURE_SEQUENCE_LENGTH + 1] = {0};
+
+        for (int j = 0; j < MAX_GESTURE_SEQUENCE_LENGTH; j++) {
+            next[j + 1] = rows[e][j] & matcher->step_masks[j][direction];
+            if (e > 0) {
+                next[j + 1] |= rows[e - 1][j] & matcher->near_masks[j][direction];
+                next[j] |= rows[e - 1][j] & matcher->insert_masks[j][direction];
+            }
+        }
+
+        gesture_mask_t completed = 0;
+        for (int j = 0; j <= MAX_GESTURE_SEQUENCE_LENGTH; j++) {
+            rows[e][j] = next[j];
+            alive |= next[j];
+            completed |= next[j] & matcher->length_masks[j];
+        }
+
+        if (completed != 0) {
+            *complete = completed;
+            completed_any |= completed;
+        }
+    }
+
+    return (alive & ~completed_any) | *complete;
+}
+#endif
+
+// Advance the matcher state by one direction, returning the patterns still alive and
+// storing the completed ones in *complete (called by the recognizer owner)
+static gesture_mask_t advance_matcher_owned(const struct device *dev, struct gesture_source *source,
+                                            uint8_t direction, gesture_mask_t *complete) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+    const struct gesture_matcher *matcher = config->matcher;
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_TOLERANT_MATCHING)
+    if (config->max_edits > 0) {
+        return advance_tolerant_owned(dev, source, direction, complete);
+    }
+#endif
+
+    gesture_mask_t next = source->candidates & matcher->step_masks[source->sequence_len][direction];
+
+    source->candidates = next;
+    *complete = next & matcher->length_masks[source->sequence_len + 1];
+    return next;
+}
+
+// Append a direction and advance the matcher by one step (called by the recognizer owner)
+static void append_direction_owned(const struct device *dev, struct gesture_source *source,
+                                   uint8_t direction) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+    struct input_processor_mouse_gesture_data *data = dev->data;
+    int64_t now = k_uptime_get();
+    int64_t cooldown_end = source->last_gesture_time + config->gesture_cooldown_ms;
+    gesture_mask_t complete;
+
+    if (source->sequence_len >= MAX_GESTURE_SEQUENCE_LENGTH) {
+        LOG_WRN("Gesture sequence too long, clearing");
+        GESTURE_STAT_INC(data, sequence_overflows);
+        reset_sequence_owned(dev, source);
+    }
+
+    gesture_mask_t next = advance_matcher_owned(dev, source, direction, &complete);
+
+    if (next == 0 && source->pending_match != 0) {
+        if (now >= cooldown_end) {
+            // The user moved on without extending the longer pattern, so they meant the
+            // shorter one
+            LOG_DBG("Sequence left the longer patterns, committing the pending match");
+            fire_match_owned(dev, source, source->pending_match);
+            return;
+        }
+
+        // Still cooling down, so the held match was trailing motion of the last gesture
+        LOG_DBG("Sequence left the longer patterns during cooldown, dropping the pending match");
+        GESTURE_STAT_INC(data, cooldown_rejects);
+        source->pending_match = 0;
+    }
+
+    if (next == 0 && source->sequence_len > 0) {
+        // No pattern continues this prefix; start over with this direction as the first stroke
+        LOG_DBG("Dead-end gesture prefix, restarting sequence");
+        reset_sequence_owned(dev, source);
+        next = advance_matcher_owned(dev, source, direction, &complete);
+    }
+
+    if (next == 0) {
+        LOG_DBG("No pattern starts with direction %d", direction);
+        reset_sequence_owned(dev, source);
+        return;
+    }
+
+    source->sequence |= (gesture_sequence_t)direction << (4 * source->sequence_len);
+    source->sequence_len++;
+    LOG_DBG("Added direction %d to sequence 0x%x (length: %d)", direction, source->sequence,
+            source->sequence_len);
+
+    source->pending_match = 0;
+
+    if (complete == 0) {
+        return;
+    }
+
+    bool ambiguous = (next & ~complete) != 0 && config->commit_timeout_ms > 0;
+
+    // Unambiguous: no longer pattern shares this prefix, fire without waiting
+    if (!ambiguous && now >= cooldown_end) {
+        fire_match_owned(dev, source, complete);
+        return;
+    }
+
+    // Hold the match until the commit timeout (if ambiguous) and the cooldown have passed, a
+    // diverging stroke or deactivation. The sequence keeps growing meanwhile, so a longer
+    // pattern drawn right after a gesture still wins over its prefix.
+    int64_t deadline = ambiguous ? now + config->commit_timeout_ms : now;
+
+    if (deadline < cooldown_end) {
+        LOG_DBG("Still in cooldown period, holding the match");
+        GESTURE_STAT_INC(data, cooldown_rejects);
+        deadline = cooldown_end;
+    }
+
+    LOG_DBG("Holding gesture match for %u ms", (uint32_t)(deadline - now));
+    source->pending_match = complete;
+    source->pending_deadline = deadline;
+    GESTURE_WORK_RESCHEDULE(&source->commit_work, K_MSEC(deadline - now));
+}
+
+// Safe accumulation with overflow protection
+static int accumulate_movement_safe(int32_t *accumulator, int32_t delta, const char* axis) {
+    // Check for overflow
+    if ((*accumulator > 0 && delta > INT32_MAX - *accumulator) ||
+        (*accumulator < 0 && delta < INT32_MIN - *accumulator)) {
+        LOG_WRN("Movement accumulator overflow on %s axis, resetting (acc=%d, delta=%d)",
+                axis, *accumulator, delta);
+        *accumulator = delta;
+        return -EOVERFLOW;
+    }
+
+    *accumulator += delta;
+    return 0;
+}
+
+// 2^(-i/16) in Q16, the fractional part of an exponential decay
+static const uint32_t gesture_decay_q16[16] = {
+    65536, 62757, 60097, 57549, 55109, 52773, 50535, 48393,
+    46341, 44376, 42495, 40693, 38968, 37316, 35734, 34219,
 };
 
-struct input_processor_mouse_gesture_config {
-    uint32_t stroke_size;
-    uint32_t movement_threshold;
-    uint32_t gesture_cooldown_ms;  // Cooldown period between gestures
-    bool enable_8way;  // true: 8 directions, false: 4 directions only
-    struct gesture_pattern **patterns;  // Array of pointers to patterns
-    size_t pattern_count;
-};
+// Scale a stroke accumulator by 2^(-sixteenths / 16), i.e. decay it for sixteenths of a half-life
+static int32_t decay_accumulator(int32_t acc, int64_t sixteenths) {
+    if (sixteenths >= 16 * 31) {
+        return 0;
+    }
+
+    int64_t scaled = (int64_t)acc * gesture_decay_q16[sixteenths % 16] / 65536;
+    return (int32_t)(scaled / ((int64_t)1 << (sixteenths / 16)));
+}
+
+// Distance that completes a stroke; faster strokes need less travel when flicks are enabled
+static uint32_t stroke_threshold(const struct input_processor_mouse_gesture_config *config,
+                                 uint32_t distance, int64_t elapsed) {
+    if (config->flick_velocity == 0) {
+        return config->stroke_size;
+    }
+
+    uint64_t velocity = (uint64_t)distance * 1000 / MAX(elapsed, 1);
+    uint64_t saving = (uint64_t)(config->stroke_size - config->flick_stroke_size) *
+                      MIN(velocity, config->flick_velocity) / config->flick_velocity;
+
+    return config->stroke_size - (uint32_t)saving;
+}
+
+// Feed one drained X/Y delta into the recognizer (called by the recognizer owner)
+static void process_movement_owned(const struct device *dev, struct gesture_source *source,
+                                   int32_t dx, int32_t dy, int64_t current_time) {
+    struct input_processor_mouse_gesture_data *data = dev->data;
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+
+    // Event loop protection: a second's worth of loop-guard-rate passes may be used up at
+    // once, so only input that keeps outpacing the rate, like a feedback loop, trips it
+    if (!take_token(&source->loop_bucket, config->loop_guard_rate, config->loop_guard_rate,
+                    current_time)) {
+        // Logged and counted once per trip, not for every pass dropped during it
+        if (!source->loop_tripped) {
+            LOG_ERR("Too many recognition passes, possible loop detected");
+            GESTURE_STAT_INC(data, loop_guard_trips);
+            source->loop_tripped = true;
+        }
+        source->repeat = NULL;
+        reset_sequence_owned(dev, source);
+        return;
+    }
+    if (source->loop_tripped) {
+        LOG_DBG("Loop guard released");
+        source->loop_tripped = false;
+    }
+
+    // Merged motion is thresholded as a whole, like a frame, instead of each event
+    if (config->frame_sync || config->decimation_us > 0) {
+        if (ABS(dx) < config->movement_threshold) {
+            dx = 0;
+        }
+        if (ABS(dy) < config->movement_threshold) {
+            dy = 0;
+        }
+        if (dx == 0 && dy == 0) {
+            GESTURE_STAT_INC(data, below_threshold);
+            return;
+        }
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES)
+    if (config->shape_patterns != 0) {
+        record_path_owned(dev, source, dx, dy);
+    }
+#endif
+
+    // Movement that trickles in slower than the half-life never adds up to a stroke. Decay
+    // is applied in whole sixteenths of a half-life and the remainder carries over, so
+    // frequent events still decay. Queued samples may be older than the last pass.
+    if (config->decay_half_life_ms > 0) {
+        int64_t sixteenths =
+            MAX(current_time - source->decay_time, 0) * 16 / config->decay_half_life_ms;
+        if (sixteenths > 0) {
+            source->acc_x = decay_accumulator(source->acc_x, sixteenths);
+            source->acc_y = decay_accumulator(source->acc_y, sixteenths);
+            source->decay_time += sixteenths * config->decay_half_life_ms / 16;
+        }
+    }
+
+    if (source->acc_x == 0 && source->acc_y == 0) {
+        source->stroke_start = current_time;
+        source->decay_time = current_time;
+    }
+
+    // Accumulate with overflow protection
+    if (dx != 0 && accumulate_movement_safe(&source->acc_x, dx, "X") < 0) {
+        GESTURE_STAT_INC(data, accumulator_overflows);
+    }
+    if (dy != 0 && accumulate_movement_safe(&source->acc_y, dy, "Y") < 0) {
+        GESTURE_STAT_INC(data, accumulator_overflows);
+    }
+
+    // Check for direction detection
+    uint32_t total_distance = ABS(source->acc_x) + ABS(source->acc_y);
+    int64_t stroke_ms = MAX(current_time - source->stroke_start, 0);
 
-// Deferred execution data
-struct deferred_gesture_execution {
-    struct k_work work;
-    struct zmk_behavior_binding bindings[MAX_DEFERRED_BINDINGS];
-    size_t binding_count;
-    struct zmk_behavior_binding_event event;
-};
+    if (total_distance < stroke_threshold(config, total_distance, stroke_ms)) {
+        return;
+    }
 
-struct input_processor_mouse_gesture_data {
-    struct k_mutex lock;
-    int32_t acc_x;
-    int32_t acc_y;
-    uint8_t sequence[MAX_GESTURE_SEQUENCE_LENGTH];
-    uint8_t sequence_len;
-    int64_t last_gesture_time;  // Timestamp of last gesture execution
-    uint32_t event_count;       // Counter to detect potential loops
-    int64_t last_reset_time;    // Time of last counter reset
-    struct deferred_gesture_execution deferred_exec;  // Work queue item
-};
+    uint8_t direction = gesture_detect_direction(source->acc_x, source->acc_y, &config->quantizer);
 
-static uint8_t detect_direction(int32_t x, int32_t y, bool enable_8way) {
-    uint16_t abs_x = ABS(x);
-    uint16_t abs_y = ABS(y);
+    if (direction != GESTURE_SECTOR_NONE) {
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS)
+        histogram_add(&data->stats.stroke_ms, (uint32_t)stroke_ms);
+#endif
 
-    if (enable_8way) {
-        if (abs_x * 5 > abs_y * 12) {
-            return GESTURE_X(x);
-        } else if (abs_y * 5 > abs_x * 12) {
-            return GESTURE_Y(y);
-        } else {
-            return GESTURE_XY(x, y);
+        if (source->repeat != NULL && direction != source->repeat_direction) {
+            LOG_DBG("Direction changed, leaving repeat mode");
+            source->repeat = NULL;
         }
-    } else {
-        if (abs_x > abs_y) {
-            return GESTURE_X(x);
+
+        if (source->repeat != NULL) {
+            // Repeats bypass the cooldown, the token bucket limits their rate instead
+            repeat_gesture_owned(dev, source, current_time);
+        } else if (source->sequence_len > 0 &&
+                   GESTURE_SEQUENCE_AT(source->sequence, source->sequence_len - 1) == direction) {
+            // Check for duplicate direction
+            LOG_DBG("Ignoring duplicate direction %d", direction);
         } else {
-            return GESTURE_Y(y);
+            append_direction_owned(dev, source, direction);
         }
+
+        // Reset accumulation for next direction
+        source->acc_x = 0;
+        source->acc_y = 0;
     }
+}
 
-    return GESTURE_NONE;
+static bool has_pending_movement(struct gesture_source *source) {
+    return atomic_get(&source->pending_x) != 0 || atomic_get(&source->pending_y) != 0;
 }
 
-// Check if pattern matches and update state atomically (called while mutex is held)
-static struct gesture_pattern* check_and_process_pattern_locked(const struct device *dev) {
-    const struct input_processor_mouse_gesture_config *config = dev->config;
+// Post the deltas buffered for a report as one frame; returns whether there were any
+static bool publish_frame(struct gesture_source *source) {
+    atomic_val_t x = atomic_clear(&source->frame_x);
+    atomic_val_t y = atomic_clear(&source->frame_y);
+
+    if (x == 0 && y == 0) {
+        return false;
+    }
+
+    atomic_add(&source->pending_x, x);
+    atomic_add(&source->pending_y, y);
+    return true;
+}
+
+static bool has_pending_work(struct gesture_source *source) {
+#if GESTURE_SPLIT_CENTRAL
+    if (atomic_get(&source->remote_matches) != 0) {
+        return true;
+    }
+#endif
+    return has_pending_movement(source) || atomic_get(&source->reset_requested) != 0 ||
+           atomic_get(&source->commit_requested) != 0;
+}
+
+// Hand the motion consumed during the ended activation to the replay work if it matched
+// nothing (called by the recognizer owner, right after the deactivation commit)
+static void request_replay_owned(const struct device *dev, struct gesture_source *source) {
     struct input_processor_mouse_gesture_data *data = dev->data;
-    int64_t current_time = k_uptime_get();
+    atomic_val_t x = atomic_clear(&source->consumed_x);
+    atomic_val_t y = atomic_clear(&source->consumed_y);
 
-    // Early validation
-    if (config->pattern_count == 0 || data->sequence_len == 0) {
-        return NULL;
+    if (atomic_get(&source->matched) || (x == 0 && y == 0)) {
+        return;
     }
 
-    // Check cooldown period
-    if (current_time - data->last_gesture_time < config->gesture_cooldown_ms) {
-        LOG_DBG("Still in cooldown period");
-        return NULL;
+    atomic_add(&source->replay_x, x);
+    atomic_add(&source->replay_y, y);
+    GESTURE_WORK_SUBMIT(&data->replay_work);
+}
+
+// Recognize the motion posted since the last pass (called by the recognizer owner)
+static void process_pending_owned(const struct device *dev, struct gesture_source *source,
+                                  int64_t now) {
+    struct input_processor_mouse_gesture_data *data = dev->data;
+    int32_t dx = (int32_t)atomic_clear(&source->pending_x);
+    int32_t dy = (int32_t)atomic_clear(&source->pending_y);
+
+    if (dx != 0 || dy != 0) {
+        GESTURE_STAT_ADD(data, motion_x, dx);
+        GESTURE_STAT_ADD(data, motion_y, dy);
+        process_movement_owned(dev, source, dx, dy, now);
     }
+}
 
-    // Find matching pattern
-    for (size_t i = 0; i < config->pattern_count; i++) {
-        const struct gesture_pattern *pattern = config->patterns[i];
+// Take recognizer ownership of a source and process everything posted to it so far, or
+// leave it to the current owner, which re-checks for posted work before giving up ownership.
+// `now` is when the motion was reported, which lags the current time in the recognizer thread.
+static void run_recognizer(const struct device *dev, struct gesture_source *source, int64_t now) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+    struct input_processor_mouse_gesture_data *data = dev->data;
 
-        if (pattern->pattern_len != data->sequence_len) {
-            continue;
+    do {
+        if (!atomic_cas(&source->recognizer, 0, 1)) {
+            GESTURE_STAT_INC(data, handoffs);
+            return;
         }
 
-        bool match = true;
-        for (size_t j = 0; j < pattern->pattern_len; j++) {
-            if (pattern->pattern[j] != data->sequence[j]) {
-                match = false;
-                break;
+        // Start every activation from a clean slate; releasing the activation key
+        // commits a match that was waiting for a longer pattern, once the motion merged
+        // by decimation or buffered for a frame before the release is recognized
+        atomic_val_t reset = atomic_clear(&source->reset_requested);
+        if (reset != 0) {
+            if (reset & GESTURE_RESET_COMMIT) {
+                process_pending_owned(dev, source, now);
+                commit_pending_match_owned(dev, source, true);
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES)
+                recognize_shape_owned(dev, source);
+#endif
+                if (config->replay_motion) {
+                    request_replay_owned(dev, source);
+                }
             }
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES)
+            reset_path_owned(dev, source);
+#endif
+            source->acc_x = 0;
+            source->acc_y = 0;
+            source->repeat = NULL;
+            reset_sequence_owned(dev, source);
+        }
+
+        process_pending_owned(dev, source, now);
+
+        if (atomic_clear(&source->commit_requested)) {
+            commit_pending_match_owned(dev, source, false);
+        }
+
+#if GESTURE_SPLIT_CENTRAL
+        gesture_mask_t remote = (gesture_mask_t)atomic_clear(&source->remote_matches);
+        if (remote != 0) {
+            execute_remote_matches_owned(dev, source, remote);
         }
+#endif
+
+        atomic_clear(&source->recognizer);
+
+        // Work posted after our drain but before release would otherwise be stranded
+    } while (has_pending_work(source));
+}
 
-        if (match) {
-            LOG_INF("Gesture pattern matched: %zu", i);
+// Source of an input device, claimed on its first event. Devices beyond the table
+// share its last source.
+static struct gesture_source *find_source(const struct device *dev, const struct device *input) {
+    struct input_processor_mouse_gesture_data *data = dev->data;
+
+    for (size_t i = 0; i < GESTURE_SOURCES; i++) {
+        struct gesture_source *source = &data->sources[i];
+        const struct device *owner = atomic_ptr_get(&source->input);
 
-            // Update all state atomically - no separate flag reset needed
-            data->last_gesture_time = current_time;
-            data->sequence_len = 0;  // Clear sequence
-            // Note: NOT setting gesture_in_progress to true - keep it simple
+        if (owner == NULL && input != NULL &&
+            atomic_ptr_cas(&source->input, NULL, (void *)input)) {
+            LOG_DBG("Input device %s uses gesture source %zu", input->name, i);
+            return source;
+        }
 
-            return (struct gesture_pattern*)pattern;
+        // Re-read, another producer may have claimed the free source for this device
+        if (atomic_ptr_get(&source->input) == input) {
+            return source;
         }
     }
 
-    return NULL;
+    return &data->sources[GESTURE_SOURCES - 1];
 }
 
-// Work queue handler for deferred gesture execution
-static void deferred_gesture_work_handler(struct k_work *work) {
-    struct deferred_gesture_execution *exec = CONTAINER_OF(work, struct deferred_gesture_execution, work);
+// Recognize posted motion, at most once per decimation interval. Motion arriving sooner
+// adds up in the pending accumulators and is picked up by the next pass, or by the
+// flush once movement stops, so recognition cost follows the decimated rate instead of
+// the sensor's polling rate.
+static void request_recognition(const struct device *dev, struct gesture_source *source,
+                                int64_t now) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+    struct input_processor_mouse_gesture_data *data = dev->data;
+
+    if (config->decimation_us > 0) {
+        uint32_t cycles = k_cycle_get_32();
+
+        if ((int32_t)(cycles - (uint32_t)atomic_get(&source->next_pass)) < 0) {
+            GESTURE_STAT_INC(data, decimated);
+            GESTURE_WORK_SCHEDULE(&source->flush_work, K_USEC(config->decimation_us));
+            return;
+        }
+        atomic_set(&source->next_pass, (atomic_val_t)(cycles + data->decimation_cycles));
+    }
+
+    run_recognizer(dev, source, now);
+}
 
-    LOG_DBG("Executing deferred gesture with %zu bindings", exec->binding_count);
+// Recognize motion merged by decimation after the last pass
+static void flush_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct gesture_source *source = CONTAINER_OF(dwork, struct gesture_source, flush_work);
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+    // The thread is the only recognizer, so the flush stays ordered with queued samples
+    atomic_set(&source->flush_requested, 1);
+    k_sem_give(&gesture_sample_sem);
+#else
+    run_recognizer(source->dev, source, k_uptime_get());
+#endif
+}
 
-    // Execute behaviors in work queue context (safe from deadlock)
-    for (size_t k = 0; k < exec->binding_count; k++) {
-        LOG_DBG("Executing deferred binding [%zu/%zu]", k + 1, exec->binding_count);
+// Commit timeout for ambiguous matches
+static void commit_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct gesture_source *source = CONTAINER_OF(dwork, struct gesture_source, commit_work);
 
-        int ret = zmk_behavior_queue_add(&exec->event, exec->bindings[k], true, k * 30);
-        if (ret < 0) {
-            LOG_ERR("Failed to queue deferred press event [%zu]: %d", k, ret);
+    atomic_set(&source->commit_requested, 1);
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+    k_sem_give(&gesture_sample_sem);
+#else
+    run_recognizer(source->dev, source, k_uptime_get());
+#endif
+}
+
+// Report the motion consumed during an activation that matched nothing, so the cursor
+// ends up where it would have been without gestures. Each source replays its own motion,
+// handed over by its recognizer owner once the deactivation commit has run.
+static void replay_work_handler(struct k_work *work) {
+    struct input_processor_mouse_gesture_data *data =
+        CONTAINER_OF(work, struct input_processor_mouse_gesture_data, replay_work);
+
+    for (size_t i = 0; i < GESTURE_SOURCES; i++) {
+        struct gesture_source *source = &data->sources[i];
+        const struct device *input = atomic_ptr_get(&source->input);
+        int32_t x = (int32_t)atomic_clear(&source->replay_x);
+        int32_t y = (int32_t)atomic_clear(&source->replay_y);
+
+        if (input == NULL || (x == 0 && y == 0)) {
             continue;
         }
 
-        ret = zmk_behavior_queue_add(&exec->event, exec->bindings[k], false, (k * 30) + 80);
+        LOG_DBG("No gesture matched, replaying consumed motion (%d, %d)", x, y);
+
+        // The processor is inactive by now, so the replayed events pass through it
+        int ret = input_report_rel(input, INPUT_REL_X, x, false, K_NO_WAIT);
+        if (ret == 0) {
+            ret = input_report_rel(input, INPUT_REL_Y, y, true, K_NO_WAIT);
+        }
         if (ret < 0) {
-            LOG_ERR("Failed to queue deferred release event [%zu]: %d", k, ret);
+            LOG_WRN("Failed to replay consumed motion: %d", ret);
         }
     }
-
-    LOG_DBG("Deferred gesture execution completed");
 }
 
-// Schedule gesture execution via work queue (completely asynchronous)
-static void schedule_gesture_execution(const struct device *dev, struct gesture_pattern *pattern) {
-    if (!pattern || pattern->bindings_len == 0) {
-        return;
+#if GESTURE_SPLIT_CENTRAL
+// Hand a pattern matched by the split peripheral to the source's recognizer owner, so it
+// executes in order with the source's own matches and commits
+static int handle_remote_match(const struct device *dev, struct gesture_source *source,
+                               uint32_t index) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+
+    if (index >= config->pattern_count) {
+        LOG_WRN("Peripheral sent unknown gesture pattern %u", index);
+        return ZMK_INPUT_PROC_STOP;
     }
 
+    atomic_or(&source->remote_matches, (atomic_val_t)BIT(index));
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+    k_sem_give(&gesture_sample_sem);
+#else
+    run_recognizer(dev, source, k_uptime_get());
+#endif
+
+    return ZMK_INPUT_PROC_STOP;
+}
+#endif
+
+// Recognition half of the event path. Runs in the input handler, or in the recognizer
+// thread for samples taken from the ring; `time` is when the event was reported.
+static void recognize_motion(const struct device *dev, struct gesture_source *source,
+                             uint16_t code, int32_t value, bool sync, int64_t time) {
     struct input_processor_mouse_gesture_data *data = dev->data;
-    struct deferred_gesture_execution *exec = &data->deferred_exec;
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+    bool is_motion = code != GESTURE_SAMPLE_SYNC;
+
+    // Counted here rather than by the handler, so in the recognizer thread consumed motion
+    // lands in the activation its sample was tagged with
+    if (is_motion && config->replay_motion) {
+        atomic_add(code == INPUT_REL_X ? &source->consumed_x : &source->consumed_y, value);
+    }
 
-    // Prevent work queue overflow
-    if (pattern->bindings_len > MAX_DEFERRED_BINDINGS) {
-        LOG_WRN("Too many bindings to defer (%zu > %d), truncating",
-                pattern->bindings_len, MAX_DEFERRED_BINDINGS);
+    if (config->frame_sync) {
+        // Buffer the report's deltas apart from the pending ones and post the whole X/Y
+        // frame on its sync event, so a concurrent owner never recognizes half a report
+        if (is_motion) {
+            GESTURE_STAT_INC(data, events);
+            atomic_add(code == INPUT_REL_X ? &source->frame_x : &source->frame_y, value);
+        }
+        if (sync && publish_frame(source)) {
+            request_recognition(dev, source, time);
+        }
+        return;
     }
 
-    // Setup execution data
-    exec->binding_count = MIN(pattern->bindings_len, MAX_DEFERRED_BINDINGS);
-    memcpy(exec->bindings, pattern->bindings, exec->binding_count * sizeof(struct zmk_behavior_binding));
+    // Only process relative x/y events
+    if (!is_motion) {
+        return;
+    }
 
-    exec->event.position = INT32_MAX;
-    exec->event.timestamp = k_uptime_get();
-#if IS_ENABLED(CONFIG_ZMK_SPLIT)
-    exec->event.source = ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL;
-#endif
+    GESTURE_STAT_INC(data, events);
 
-    // Submit to system work queue (completely asynchronous)
-    int ret = k_work_submit(&exec->work);
-    if (ret < 0) {
-        LOG_ERR("Failed to submit gesture work: %d", ret);
-    } else {
-        LOG_DBG("Gesture execution scheduled successfully");
+    // Cut off small movements, unless they are merged and thresholded together
+    if (config->decimation_us == 0 && ABS(value) < config->movement_threshold) {
+        GESTURE_STAT_INC(data, below_threshold);
+        return;
     }
+
+    // Post the delta; whichever producer owns the source's recognizer will consume it
+    atomic_add(code == INPUT_REL_X ? &source->pending_x : &source->pending_y, value);
+    request_recognition(dev, source, time);
 }
 
-// Safe accumulation with overflow protection
-static int accumulate_movement_safe(int32_t *accumulator, int32_t delta, const char* axis) {
-    // Check for overflow
-    if ((*accumulator > 0 && delta > INT32_MAX - *accumulator) ||
-        (*accumulator < 0 && delta < INT32_MIN - *accumulator)) {
-        LOG_WRN("Movement accumulator overflow on %s axis, resetting (acc=%d, delta=%d)",
-                axis, *accumulator, delta);
-        *accumulator = delta;
-        return -EOVERFLOW;
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+// Hand an event to the recognizer thread; a full ring drops it rather than block input
+static void push_sample(const struct device *dev, struct gesture_source *source, uint16_t code,
+                        int32_t value, bool sync) {
+    struct input_processor_mouse_gesture_data *data = dev->data;
+    struct gesture_sample_ring *ring = &data->sample_ring;
+    uint32_t generation = (uint32_t)atomic_get(&data->generation);
+    uint32_t head = (uint32_t)atomic_get(&ring->head);
+
+    // Deactivated since the caller checked
+    if ((generation & 1) == 0) {
+        return;
     }
 
-    *accumulator += delta;
-    return 0;
+    if (head - (uint32_t)atomic_get(&ring->tail) >= GESTURE_SAMPLE_RING_SIZE) {
+        atomic_inc(&ring->overflows);
+        return;
+    }
+
+    struct gesture_sample *sample = &ring->samples[head % GESTURE_SAMPLE_RING_SIZE];
+    sample->source = source;
+    sample->timestamp = k_uptime_get();
+    sample->generation = generation;
+    sample->value = value;
+    sample->code = code;
+    sample->sync = sync;
+
+    // Publish the slot only after it is fully written
+    atomic_set(&ring->head, (atomic_val_t)(head + 1));
+    k_sem_give(&gesture_sample_sem);
 }
 
-static int input_processor_mouse_gesture_handle_event_locked(const struct device *dev,
-                                                      struct input_event *event,
-                                                      uint32_t param1, uint32_t param2,
-                                                      struct zmk_input_processor_state *state) {
+// Move the recognizer to a later activation (called by the recognizer thread). Every
+// sample of the ended activation has been recognized by now, including motion merged by
+// decimation, so its pending match is committed only after all of its strokes.
+static void apply_activation_edges(const struct device *dev, uint32_t generation) {
     struct input_processor_mouse_gesture_data *data = dev->data;
-    const struct input_processor_mouse_gesture_config *config = dev->config;
-    int64_t current_time = k_uptime_get();
+    uint32_t edges = generation - data->recognized_generation;
+    bool ended = (data->recognized_generation & 1) != 0 || edges > 1;
+
+    LOG_DBG("Applying %u activation edges", edges);
+    data->recognized_generation = generation;
+
+    for (size_t i = 0; i < GESTURE_SOURCES; i++) {
+        struct gesture_source *source = &data->sources[i];
+
+        if (atomic_ptr_get(&source->input) == NULL) {
+            continue;
+        }
+
+        int64_t now = k_uptime_get();
 
-    // Event loop protection
-    if (current_time - data->last_reset_time > 1000) {  // Reset every second
-        data->event_count = 0;
-        data->last_reset_time = current_time;
+        // A report cut short by the release still belongs to the ended activation
+        if (ended) {
+            publish_frame(source);
+            run_recognizer(dev, source, now);
+        }
+        atomic_or(&source->reset_requested, ended ? GESTURE_RESET | GESTURE_RESET_COMMIT
+                                                  : GESTURE_RESET);
+        run_recognizer(dev, source, now);
+
+        // The ended activation's replay has been decided, the next one starts unmatched
+        atomic_clear(&source->consumed_x);
+        atomic_clear(&source->consumed_y);
+        atomic_clear(&source->matched);
     }
+}
 
-    data->event_count++;
-    if (data->event_count > 1000) {  // Prevent event loops
-        LOG_ERR("Too many events in short time, possible loop detected");
-        data->sequence_len = 0;
-        data->event_count = 0;
-        return ZMK_INPUT_PROC_CONTINUE;
+// Recognize every sample queued for a processor, in order with activation edges, commit
+// timeouts and decimation flushes (called by the recognizer thread)
+static void drain_samples(const struct device *dev) {
+    struct input_processor_mouse_gesture_data *data = dev->data;
+    struct gesture_sample_ring *ring = &data->sample_ring;
+    uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+
+    while (tail != (uint32_t)atomic_get(&ring->head)) {
+        const struct gesture_sample *sample = &ring->samples[tail % GESTURE_SAMPLE_RING_SIZE];
+        int32_t age = (int32_t)(sample->generation - data->recognized_generation);
+
+        if (age > 0) {
+            apply_activation_edges(dev, sample->generation);
+        }
+
+        // A sample tagged just before a deactivation that was already applied
+        if (age >= 0) {
+            recognize_motion(dev, sample->source, sample->code, sample->value, sample->sync,
+                             sample->timestamp);
+        }
+
+        tail++;
+        atomic_set(&ring->tail, (atomic_val_t)tail);
+    }
+
+    // Edges with no motion after them, e.g. the final deactivation
+    uint32_t generation = (uint32_t)atomic_get(&data->generation);
+    if (generation != data->recognized_generation) {
+        apply_activation_edges(dev, generation);
+    }
+
+    for (size_t i = 0; i < GESTURE_SOURCES; i++) {
+        struct gesture_source *source = &data->sources[i];
+
+        if (atomic_clear(&source->flush_requested) || has_pending_work(source)) {
+            run_recognizer(dev, source, k_uptime_get());
+        }
     }
 
-    // Check if mouse gesture is active (early exit)
-    if (!zmk_mouse_gesture_is_active()) {
-        data->acc_x = 0;
-        data->acc_y = 0;
-        data->sequence_len = 0;
+    // Logged here rather than by the producer, which must stay cheap
+    atomic_val_t overflows = atomic_get(&ring->overflows);
+    if (overflows != ring->overflows_reported) {
+        LOG_WRN("Gesture sample ring full, %ld samples dropped so far", (long)overflows);
+        ring->overflows_reported = overflows;
+    }
+}
+#endif
+
+static int handle_motion_event(const struct device *dev, struct input_event *event) {
+    struct input_processor_mouse_gesture_data *data = dev->data;
+    const struct input_processor_mouse_gesture_config *config = dev->config;
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SPLIT_RECOGNITION)
+    // Gesture reports of the split peripheral are not motion. Filtered before the
+    // frame-sync path, which would take their sync for the end of a motion report, and on
+    // the central checked before the activation state: a release can commit a match on
+    // the peripheral.
+    if (event->type == INPUT_EV_MSC && event->code == GESTURE_SPLIT_EVENT_CODE &&
+        ((uint32_t)event->value & GESTURE_SPLIT_TAG_MASK) == GESTURE_SPLIT_EVENT_TAG) {
+#if GESTURE_SPLIT_CENTRAL
+        return handle_remote_match(dev, find_source(dev, event->dev),
+                                   (uint32_t)event->value & ~GESTURE_SPLIT_TAG_MASK);
+#else
         return ZMK_INPUT_PROC_CONTINUE;
+#endif
     }
+#endif
 
-    // Only process relative x/y events
-    if (!(event->type == INPUT_EV_REL && (event->code == INPUT_REL_X || event->code == INPUT_REL_Y))) {
+    // Plain cursor movement while gestures are inactive pays for this check only
+    if (!atomic_get(&data->active)) {
         return ZMK_INPUT_PROC_CONTINUE;
     }
 
-    // Cut off small movements
-    if (ABS(event->value) < config->movement_threshold) {
+    bool is_motion =
+        event->type == INPUT_EV_REL && (event->code == INPUT_REL_X || event->code == INPUT_REL_Y);
+
+    // Only motion, and in frame mode the sync ending a report, reach the recognizer
+    if (!is_motion && !(config->frame_sync && event->sync)) {
         return ZMK_INPUT_PROC_CONTINUE;
     }
 
-    // Accumulate with overflow protection
-    if (event->code == INPUT_REL_X) {
-        accumulate_movement_safe(&data->acc_x, event->value, "X");
-    } else if (event->code == INPUT_REL_Y) {
-        accumulate_movement_safe(&data->acc_y, event->value, "Y");
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_TRACE)
+    // Raw events, before any thresholding, so traces can be replayed with other settings
+    if (is_motion) {
+        zmk_mouse_gesture_trace_motion(event->code, event->value, event->sync);
     }
+#endif
 
-    // Check for direction detection
-    uint32_t total_distance = ABS(data->acc_x) + ABS(data->acc_y);
+    struct gesture_source *source = find_source(dev, event->dev);
 
-    if (total_distance < config->stroke_size) {
-        return ZMK_INPUT_PROC_CONTINUE;
+    // Consumed motion is not sent to the host; other events such as buttons still are.
+    // A recognizing split peripheral always consumes it, that is the point of recognizing there.
+    int ret = ZMK_INPUT_PROC_CONTINUE;
+    if (is_motion && (config->consume_motion || GESTURE_SPLIT_PERIPHERAL)) {
+        ret = ZMK_INPUT_PROC_STOP;
     }
 
-    uint8_t direction = detect_direction(data->acc_x, data->acc_y, config->enable_8way);
+    uint16_t code = is_motion ? event->code : GESTURE_SAMPLE_SYNC;
+    int32_t value = is_motion ? event->value : 0;
 
-    if (direction != GESTURE_NONE) {
-        // Check for duplicate direction
-        if (data->sequence_len > 0 && data->sequence[data->sequence_len - 1] == direction) {
-            LOG_DBG("Ignoring duplicate direction %d", direction);
-        } else {
-            // Add direction to sequence
-            if (data->sequence_len < MAX_GESTURE_SEQUENCE_LENGTH) {
-                data->sequence[data->sequence_len++] = direction;
-                LOG_DBG("Added direction %d to sequence (length: %d)", direction, data->sequence_len);
-            } else {
-                LOG_WRN("Gesture sequence too long, clearing");
-                data->sequence_len = 0;
-            }
-        }
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+    push_sample(dev, source, code, value, event->sync);
+#else
+    recognize_motion(dev, source, code, value, event->sync, k_uptime_get());
+#endif
 
-        // Reset accumulation for next direction
-        data->acc_x = 0;
-        data->acc_y = 0;
+    return ret;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_PROFILE)
+// Aggregate handler cost and log it once per profiling interval
+static void record_event_cycles(struct input_processor_mouse_gesture_data *data, uint32_t cycles) {
+    atomic_add(&data->profile_cycles, cycles);
+
+    atomic_val_t max = atomic_get(&data->profile_max);
+    while ((uint32_t)max < cycles && !atomic_cas(&data->profile_max, max, cycles)) {
+        max = atomic_get(&data->profile_max);
+    }
+
+    if (atomic_inc(&data->profile_events) + 1 < CONFIG_ZMK_MOUSE_GESTURE_PROFILE_INTERVAL) {
+        return;
     }
 
-    return ZMK_INPUT_PROC_CONTINUE;
+    uint32_t events = atomic_clear(&data->profile_events);
+    uint32_t total = atomic_clear(&data->profile_cycles);
+    uint32_t slowest = atomic_clear(&data->profile_max);
+
+    LOG_INF("Gesture handler: %u events, avg %llu ns, max %llu ns", events,
+            (unsigned long long)timing_cycles_to_ns(total / MAX(events, 1)),
+            (unsigned long long)timing_cycles_to_ns(slowest));
 }
+#endif
 
 static int input_processor_mouse_gesture_handle_event(const struct device *dev,
                                                       struct input_event *event,
                                                       uint32_t param1, uint32_t param2,
                                                       struct zmk_input_processor_state *state) {
-    struct input_processor_mouse_gesture_data *data = dev->data;
-    int ret = 0;
-
-    // Single mutex operation - acquire, process, check pattern, release
-    ret = k_mutex_lock(&data->lock, K_MSEC(5));
-    if (ret < 0) {
-        LOG_WRN("Failed to acquire mutex for gesture processing: %d", ret);
-        return ZMK_INPUT_PROC_CONTINUE;
-    }
-
-    ret = input_processor_mouse_gesture_handle_event_locked(dev, event, param1, param2, state);
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_PROFILE)
+    timing_t start = timing_counter_get();
+    int ret = handle_motion_event(dev, event);
+    timing_t end = timing_counter_get();
 
-    // Check for pattern match and update state atomically
-    struct gesture_pattern *matched_pattern = check_and_process_pattern_locked(dev);
-
-    k_mutex_unlock(&data->lock);
+    record_event_cycles(dev->data, (uint32_t)timing_cycles_get(&start, &end));
+    return ret;
+#else
+    return handle_motion_event(dev, event);
+#endif
+}
 
-    // Schedule pattern execution via work queue (deadlock-safe)
-    if (matched_pattern) {
-        LOG_DBG("Pattern matched, scheduling deferred execution");
-        schedule_gesture_execution(dev, matched_pattern);
+// Activation edge callback, runs in the context that toggled the gesture state
+static void mouse_gesture_state_changed(struct zmk_mouse_gesture_listener *listener, bool active) {
+    struct input_processor_mouse_gesture_data *data =
+        CONTAINER_OF(listener, struct input_processor_mouse_gesture_data, listener);
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+    // Samples are tagged with the generation, so the thread applies the edge right after
+    // the samples queued before it, however late it gets to them. It also clears the
+    // replay state, which the ended activation's commit still needs.
+    atomic_inc(&data->generation);
+    atomic_set(&data->active, active);
+    k_sem_give(&gesture_sample_sem);
+#else
+    // Owned state is reset by each source's recognizer owner on its next run. Motion and
+    // replay state left from before an activation are dropped right here; motion of an
+    // ended activation, including a report cut short by the release, is recognized by the
+    // commit pass.
+    for (size_t i = 0; i < GESTURE_SOURCES; i++) {
+        struct gesture_source *source = &data->sources[i];
+
+        if (active) {
+            atomic_clear(&source->pending_x);
+            atomic_clear(&source->pending_y);
+            atomic_clear(&source->frame_x);
+            atomic_clear(&source->frame_y);
+            atomic_clear(&source->consumed_x);
+            atomic_clear(&source->consumed_y);
+            atomic_clear(&source->matched);
+        } else {
+            publish_frame(source);
+        }
+        atomic_or(&source->reset_requested,
+                  active ? GESTURE_RESET : GESTURE_RESET | GESTURE_RESET_COMMIT);
     }
+    atomic_set(&data->active, active);
 
-    return ret;
+    if (!active) {
+        // Let the owners commit pending ambiguous matches without waiting for motion
+        for (size_t i = 0; i < GESTURE_SOURCES; i++) {
+            if (atomic_ptr_get(&data->sources[i].input) != NULL) {
+                GESTURE_WORK_RESCHEDULE(&data->sources[i].commit_work, K_NO_WAIT);
+            }
+        }
+    }
+#endif
 }
 
 static int input_processor_mouse_gesture_init(const struct device *dev) {
+    const struct input_processor_mouse_gesture_config *config = dev->config;
     struct input_processor_mouse_gesture_data *data = dev->data;
 
-    k_mutex_init(&data->lock);
+    data->dev = dev;
+
+    for (size_t i = 0; i < GESTURE_SOURCES; i++) {
+        struct gesture_source *source = &data->sources[i];
+
+        source->dev = dev;
+        atomic_ptr_clear(&source->input);
+        atomic_clear(&source->commit_requested);
+        k_work_init_delayable(&source->commit_work, commit_work_handler);
+        atomic_clear(&source->reset_requested);
+        atomic_clear(&source->pending_x);
+        atomic_clear(&source->pending_y);
+        atomic_clear(&source->frame_x);
+        atomic_clear(&source->frame_y);
+        atomic_clear(&source->recognizer);
+        atomic_clear(&source->consumed_x);
+        atomic_clear(&source->consumed_y);
+        atomic_clear(&source->replay_x);
+        atomic_clear(&source->replay_y);
+        atomic_clear(&source->matched);
+#if GESTURE_SPLIT_CENTRAL
+        atomic_clear(&source->remote_matches);
+#endif
+
+        source->acc_x = 0;
+        source->acc_y = 0;
+        reset_sequence_owned(dev, source);
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES)
+        reset_path_owned(dev, source);
+#endif
+        source->last_gesture_time = 0;
+        source->repeat = NULL;
+        fill_bucket(&source->repeat_bucket, config->repeat_burst, k_uptime_get());
+        fill_bucket(&source->loop_bucket, config->loop_guard_rate, k_uptime_get());
+        source->loop_tripped = false;
+        atomic_clear(&source->next_pass);
+        k_work_init_delayable(&source->flush_work, flush_work_handler);
+    }
 
-    data->acc_x = 0;
-    data->acc_y = 0;
-    data->sequence_len = 0;
-    data->last_gesture_time = 0;
-    data->event_count = 0;
-    data->last_reset_time = k_uptime_get();
+    atomic_set(&data->active, zmk_mouse_gesture_is_active());
+    data->listener.state_changed = mouse_gesture_state_changed;
+    zmk_mouse_gesture_add_listener(&data->listener);
 
     // Initialize work queue for deferred execution
-    k_work_init(&data->deferred_exec.work, deferred_gesture_work_handler);
-    data->deferred_exec.binding_count = 0;
+    k_work_init(&data->deferred_queue.work, deferred_gesture_work_handler);
+    data->deferred_queue.dev = dev;
+    atomic_clear(&data->deferred_queue.head);
+    atomic_clear(&data->deferred_queue.tail);
+    atomic_clear(&data->deferred_queue.overflows);
+
+    k_work_init(&data->replay_work, replay_work_handler);
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+    atomic_clear(&data->sample_ring.head);
+    atomic_clear(&data->sample_ring.tail);
+    atomic_clear(&data->sample_ring.overflows);
+    data->sample_ring.overflows_reported = 0;
+#endif
+    data->decimation_cycles = k_us_to_cyc_ceil32(config->decimation_us);
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_PROFILE)
+    timing_init();
+    timing_start();
+    atomic_clear(&data->profile_events);
+    atomic_clear(&data->profile_cycles);
+    atomic_clear(&data->profile_max);
+#endif
 
     LOG_INF("Mouse gesture input processor initialized with deferred execution");
     return 0;
@@ -357,42 +1730,242 @@ static struct zmk_input_processor_driver_api input_processor_mouse_gesture_drive
 #define TRANSFORMED_BINDINGS(n)                                                                    \
     { LISTIFY(DT_PROP_LEN(n, bindings), ZMK_KEYMAP_EXTRACT_BINDING, (, ), n) }
 
+// Binding lists of two pattern nodes are identical, as an integer constant expression
+#define GESTURE_BINDING_CELL(n, idx, cell) DT_PHA_BY_IDX_OR(n, bindings, idx, cell, 0)
+#define GESTURE_BINDING_EQUAL(a, prop, idx, b)                                                     \
+    && COND_CODE_1(DT_PROP_HAS_IDX(b, bindings, idx),                                               \
+                   ((DT_SAME_NODE(DT_PHANDLE_BY_IDX(a, bindings, idx),                             \
+                                  DT_PHANDLE_BY_IDX(b, bindings, idx)) &&                          \
+                     GESTURE_BINDING_CELL(a, idx, param1) == GESTURE_BINDING_CELL(b, idx, param1) && \
+                     GESTURE_BINDING_CELL(a, idx, param2) == GESTURE_BINDING_CELL(b, idx, param2))), \
+                   (0))
+#define GESTURE_BINDINGS_EQUAL(a, b)                                                               \
+    (DT_PROP_LEN(a, bindings) == DT_PROP_LEN(b, bindings)                                          \
+         DT_FOREACH_PROP_ELEM_VARGS(a, bindings, GESTURE_BINDING_EQUAL, b))
+
+/*
+ * Identical binding lists share one flash array across all processor instances: every
+ * pattern points at the first identical list in devicetree order, and the arrays nobody
+ * points at are discarded by the compiler.
+ */
+#define GESTURE_BINDINGS_IF_EQUAL(a, b)                                                            \
+    GESTURE_BINDINGS_EQUAL(a, b) ? gesture_pattern_config_##a##_bindings :
+#define GESTURE_BINDINGS_IN_INST(node, b) DT_FOREACH_CHILD_VARGS(node, GESTURE_BINDINGS_IF_EQUAL, b)
+#define GESTURE_SHARED_BINDINGS(n)                                                                 \
+    (DT_FOREACH_STATUS_OKAY_VARGS(DT_DRV_COMPAT, GESTURE_BINDINGS_IN_INST, n)                      \
+         gesture_pattern_config_##n##_bindings)
+
+#define GESTURE_PATTERN_BINDINGS(n)                                                                \
+    static const struct zmk_behavior_binding __unused                                              \
+        gesture_pattern_config_##n##_bindings[DT_PROP_LEN(n, bindings)] =                          \
+            TRANSFORMED_BINDINGS(n);
+#define GESTURE_INST_BINDINGS(inst) DT_INST_FOREACH_CHILD(inst, GESTURE_PATTERN_BINDINGS)
+
+// Every instance's binding arrays must be declared before any pattern can share them
+DT_INST_FOREACH_STATUS_OKAY(GESTURE_INST_BINDINGS)
+
+// Shape templates, interleaved X/Y as written in the devicetree
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES)
+#define GESTURE_SHAPE_TEMPLATE(n)                                                                  \
+    COND_CODE_1(DT_NODE_HAS_PROP(n, shape),                                                        \
+                (static const int32_t gesture_shape_##n[] = DT_PROP(n, shape);), ())
+#define GESTURE_PATTERN_SHAPE(n)                                                                   \
+    COND_CODE_1(DT_NODE_HAS_PROP(n, shape),                                                        \
+                (.shape = gesture_shape_##n, .shape_len = DT_PROP_LEN(n, shape) / 2, ), ())
+#else
+#define GESTURE_SHAPE_TEMPLATE(n)
+#define GESTURE_PATTERN_SHAPE(n)
+#endif
+
 // Gesture pattern instance creation
 #define GESTURE_PATTERN_INST(n)                                                                    \
-    static struct zmk_behavior_binding                                                             \
-        gesture_pattern_config_##n##_bindings[DT_PROP_LEN(n, bindings)] =                          \
-            TRANSFORMED_BINDINGS(n);                                                               \
-                                                                                                   \
-    static struct gesture_pattern gesture_pattern_cfg_##n = {                                      \
+    GESTURE_SHAPE_TEMPLATE(n)                                                                      \
+    static const struct gesture_pattern gesture_pattern_cfg_##n = {                                \
+        .bindings = GESTURE_SHARED_BINDINGS(n),                                                    \
+        .sequence = GESTURE_PATTERN_PACKED(n),                                                     \
         .bindings_len = DT_PROP_LEN(n, bindings),                                                  \
-        .bindings = gesture_pattern_config_##n##_bindings,                                         \
-        .pattern_len = DT_PROP_LEN(n, pattern),                                                    \
-        .pattern = DT_PROP(n, pattern),                                                            \
+        .pattern_len = GESTURE_PATTERN_LEN(n),                                                     \
+        .index = DT_NODE_CHILD_IDX(n),                                                             \
+        .repeat = DT_PROP(n, repeat),                                                              \
+        GESTURE_PATTERN_SHAPE(n)                                                                   \
     };
 
-// Apply to all child nodes
-DT_INST_FOREACH_CHILD(0, GESTURE_PATTERN_INST)
-
 // Create array of pattern pointers
 #define GESTURE_PATTERN_ITEM(n) &gesture_pattern_cfg_##n,
-#define GESTURE_PATTERN_UTIL_ONE(n) 1 +
 
-static struct gesture_pattern *gesture_patterns[] = {DT_INST_FOREACH_CHILD(0, GESTURE_PATTERN_ITEM)};
+#define PATTERN_COUNT(inst) GESTURE_NODE_PATTERN_COUNT(DT_DRV_INST(inst))
+
+#define GESTURE_DIRECTION_CHECK(n, prop, idx, inst)                                                \
+    BUILD_ASSERT(GESTURE_CODE_TO_SECTOR(DT_PROP_BY_IDX(n, prop, idx)) < GESTURE_DIRECTION_CODES,   \
+                 "Unknown direction in mouse gesture pattern");                                    \
+    BUILD_ASSERT(GESTURE_CODE_TO_SECTOR(DT_PROP_BY_IDX(n, prop, idx)) % GESTURE_SECTOR_STEP(inst)  \
+                     == 0,                                                                         \
+                 "Mouse gesture pattern uses a direction finer than the processor's directions");
+#define GESTURE_PATTERN_CHECK(n, inst)                                                             \
+    BUILD_ASSERT(DT_NODE_HAS_PROP(n, pattern) != DT_NODE_HAS_PROP(n, shape),                       \
+                 "Mouse gesture needs exactly one of pattern and shape");                          \
+    BUILD_ASSERT(!DT_NODE_HAS_PROP(n, shape) || IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES),       \
+                 "Mouse gesture shapes require CONFIG_ZMK_MOUSE_GESTURE_SHAPES");                  \
+    BUILD_ASSERT(DT_PROP_LEN_OR(n, shape, 4) % 2 == 0 && DT_PROP_LEN_OR(n, shape, 4) >= 4 &&       \
+                     DT_PROP_LEN_OR(n, shape, 4) / 2 <= UINT8_MAX,                                 \
+                 "Mouse gesture shape needs 2 to 255 X/Y points");                                 \
+    BUILD_ASSERT(GESTURE_PATTERN_LEN(n) <= GESTURE_STROKE_LIMIT,                                   \
+                 "Mouse gesture pattern is longer than 8 strokes");                                \
+    BUILD_ASSERT(GESTURE_PATTERN_LEN(n) <= MAX_GESTURE_SEQUENCE_LENGTH,                            \
+                 "Mouse gesture pattern does not fit gesture_sequence_t");                         \
+    BUILD_ASSERT(GESTURE_PATTERN_LEN(n) + DT_INST_PROP(inst, max_edits) <= GESTURE_STROKE_LIMIT,   \
+                 "Mouse gesture pattern length plus max-edits exceeds 8 strokes");                 \
+    BUILD_ASSERT(DT_PROP_LEN(n, bindings) <= UINT8_MAX, "Too many bindings in mouse gesture");     \
+    COND_CODE_1(DT_NODE_HAS_PROP(n, pattern),                                                      \
+                (DT_FOREACH_PROP_ELEM_VARGS(n, pattern, GESTURE_DIRECTION_CHECK, inst)), ())
+
+// Pattern sectors packed into one nibble per stroke, as an integer constant expression
+#define GESTURE_PATTERN_NIBBLE(n, prop, idx)                                                       \
+    ((uint32_t)GESTURE_CODE_TO_SECTOR(DT_PROP_BY_IDX(n, prop, idx)) << (4 * (idx))) |
+#define GESTURE_PATTERN_PACKED(n)                                                                  \
+    (COND_CODE_1(DT_NODE_HAS_PROP(n, pattern),                                                     \
+                 (DT_FOREACH_PROP_ELEM(n, pattern, GESTURE_PATTERN_NIBBLE)), ()) 0)
+#define GESTURE_PATTERN_DIR_AT(n, pos) ((GESTURE_PATTERN_PACKED(n) >> (4 * (pos))) & 0xF)
+#define GESTURE_PATTERN_BIT(n) BIT(DT_NODE_CHILD_IDX(n))
+
+// Matcher table generation
+#define GESTURE_STEP_BIT(n, pos, dir)                                                              \
+    (((pos) < GESTURE_PATTERN_LEN(n) && GESTURE_PATTERN_DIR_AT(n, pos) == (dir))                   \
+         ? GESTURE_PATTERN_BIT(n)                                                                  \
+         : 0) |
+#define GESTURE_STEP_MASK(inst, pos, dir)                                                          \
+    (DT_INST_FOREACH_CHILD_VARGS(inst, GESTURE_STEP_BIT, pos, dir) 0)
+#define GESTURE_MASK_ROW(pos, inst, mask)                                                          \
+    {                                                                                              \
+        mask(inst, pos, 0),  mask(inst, pos, 1),  mask(inst, pos, 2),  mask(inst, pos, 3),         \
+        mask(inst, pos, 4),  mask(inst, pos, 5),  mask(inst, pos, 6),  mask(inst, pos, 7),         \
+        mask(inst, pos, 8),  mask(inst, pos, 9),  mask(inst, pos, 10), mask(inst, pos, 11),        \
+        mask(inst, pos, 12), mask(inst, pos, 13), mask(inst, pos, 14), mask(inst, pos, 15),        \
+    }
+#define GESTURE_LENGTH_BIT(n, len)                                                                 \
+    ((DT_NODE_HAS_PROP(n, pattern) && GESTURE_PATTERN_LEN(n) == (len)) ? GESTURE_PATTERN_BIT(n) : 0) |
+#define GESTURE_LENGTH_MASK(len, inst)                                                             \
+    (DT_INST_FOREACH_CHILD_VARGS(inst, GESTURE_LENGTH_BIT, len) 0)
+#define GESTURE_ALL_BIT(n) (DT_NODE_HAS_PROP(n, pattern) ? GESTURE_PATTERN_BIT(n) : 0) |
+#define GESTURE_SHAPE_BIT(n) (DT_NODE_HAS_PROP(n, shape) ? GESTURE_PATTERN_BIT(n) : 0) |
+
+// Tolerant matcher tables. Neighbouring directions are one sector of the instance's
+// quantizer apart. The previous stroke is read from the word shifted up by one nibble,
+// which keeps shift counts non-negative at position 0 where inserts are never allowed.
+#define GESTURE_SECTOR_STEP(inst) (GESTURE_DIRECTION_CODES / GESTURE_DIRECTIONS(inst))
+#define GESTURE_SECTORS_ADJACENT(a, b, step)                                                       \
+    ((((a) - (b)) & 0xF) == (step) || (((b) - (a)) & 0xF) == (step))
+#define GESTURE_PATTERN_DIR_BEFORE(n, pos)                                                         \
+    ((((uint64_t)GESTURE_PATTERN_PACKED(n) << 4) >> (4 * (pos))) & 0xF)
+#define GESTURE_NEAR_BIT(n, pos, dir, step)                                                        \
+    (((pos) < GESTURE_PATTERN_LEN(n) &&                                                            \
+      GESTURE_SECTORS_ADJACENT(GESTURE_PATTERN_DIR_AT(n, pos), dir, step))                         \
+         ? GESTURE_PATTERN_BIT(n)                                                                  \
+         : 0) |
+#define GESTURE_INSERT_BIT(n, pos, dir, step)                                                      \
+    (((pos) > 0 && (pos) < GESTURE_PATTERN_LEN(n) &&                                               \
+      (GESTURE_SECTORS_ADJACENT(GESTURE_PATTERN_DIR_BEFORE(n, pos), dir, step) ||                  \
+       GESTURE_SECTORS_ADJACENT(GESTURE_PATTERN_DIR_AT(n, pos), dir, step)))                       \
+         ? GESTURE_PATTERN_BIT(n)                                                                  \
+         : 0) |
+#define GESTURE_NEAR_MASK(inst, pos, dir)                                                          \
+    (DT_INST_FOREACH_CHILD_VARGS(inst, GESTURE_NEAR_BIT, pos, dir, GESTURE_SECTOR_STEP(inst)) 0)
+#define GESTURE_INSERT_MASK(inst, pos, dir)                                                        \
+    (DT_INST_FOREACH_CHILD_VARGS(inst, GESTURE_INSERT_BIT, pos, dir, GESTURE_SECTOR_STEP(inst)) 0)
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_TOLERANT_MATCHING)
+#define GESTURE_TOLERANT_TABLES(inst)                                                              \
+    .near_masks = {LISTIFY(MAX_GESTURE_SEQUENCE_LENGTH, GESTURE_MASK_ROW, (, ), inst,              \
+                           GESTURE_NEAR_MASK)},                                                    \
+    .insert_masks = {LISTIFY(MAX_GESTURE_SEQUENCE_LENGTH, GESTURE_MASK_ROW, (, ), inst,            \
+                             GESTURE_INSERT_MASK)},
+#else
+#define GESTURE_TOLERANT_TABLES(inst)
+#endif
+
+// Per-instance pattern table and matcher, so every processor only pays for its own patterns
+#define GESTURE_PATTERN_TABLE(inst)                                                                \
+    DT_INST_FOREACH_CHILD_VARGS(inst, GESTURE_PATTERN_CHECK, inst)                                 \
+    BUILD_ASSERT(PATTERN_COUNT(inst) <= GESTURE_PATTERN_LIMIT, "Too many mouse gesture patterns"); \
+    BUILD_ASSERT(PATTERN_COUNT(inst) <= MAX_GESTURE_PATTERNS, "gesture_mask_t sized too small");   \
+                                                                                                   \
+    DT_INST_FOREACH_CHILD(inst, GESTURE_PATTERN_INST)                                              \
+                                                                                                   \
+    static const struct gesture_pattern *const gesture_patterns_##inst[] = {                       \
+        DT_INST_FOREACH_CHILD(inst, GESTURE_PATTERN_ITEM)};                                        \
+                                                                                                   \
+    static const struct gesture_matcher gesture_matcher_##inst = {                                 \
+        .step_masks = {LISTIFY(MAX_GESTURE_SEQUENCE_LENGTH, GESTURE_MASK_ROW, (, ), inst,          \
+                               GESTURE_STEP_MASK)},                                                \
+        .length_masks = {LISTIFY(UTIL_INC(MAX_GESTURE_SEQUENCE_LENGTH), GESTURE_LENGTH_MASK, (, ), \
+                                 inst)},                                                           \
+        .all_patterns = (DT_INST_FOREACH_CHILD(inst, GESTURE_ALL_BIT) 0),                          \
+        GESTURE_TOLERANT_TABLES(inst)                                                              \
+    };
+
+// Devicetree `directions`, with the legacy enable-8way flag taking precedence
+#define GESTURE_DIRECTIONS(n) (DT_INST_PROP(n, enable_8way) ? 8 : DT_INST_PROP(n, directions))
+
+#define GESTURE_QUANTIZER(n)                                                                       \
+    GESTURE_QUANTIZER_INIT(GESTURE_DIRECTIONS(n), DT_INST_PROP(n, dead_zone_deg))
 
-#define PATTERN_COUNT (DT_INST_FOREACH_CHILD(0, GESTURE_PATTERN_UTIL_ONE) 0)
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_SHAPES)
+#define GESTURE_SHAPE_CONFIG(n)                                                                    \
+    .shape_patterns = (DT_INST_FOREACH_CHILD(n, GESTURE_SHAPE_BIT) 0),                             \
+    .shape_max_distance = DT_INST_PROP(n, shape_max_distance),
+#else
+#define GESTURE_SHAPE_CONFIG(n)
+#endif
 
 #define MOUSE_GESTURE_INPUT_PROCESSOR_INST(n)                                       \
+    GESTURE_PATTERN_TABLE(n)                                                        \
     static struct input_processor_mouse_gesture_data                                \
         input_processor_mouse_gesture_data_##n = {};                                \
-    static struct input_processor_mouse_gesture_config                              \
+    static const struct input_processor_mouse_gesture_config                        \
         input_processor_mouse_gesture_config_##n = {                                \
         .stroke_size = DT_INST_PROP_OR(n, stroke_size, 1000),                       \
         .movement_threshold = DT_INST_PROP_OR(n, movement_threshold, 10),           \
+        .decay_half_life_ms = DT_INST_PROP(n, decay_half_life_ms),                  \
+        .flick_velocity = DT_INST_PROP(n, flick_velocity),                          \
+        .flick_stroke_size = DT_INST_PROP_OR(n, stroke_size, 1000) *                \
+                             DT_INST_PROP(n, flick_stroke_percent) / 100,           \
         .gesture_cooldown_ms = DT_INST_PROP_OR(n, gesture_cooldown_ms, 200),        \
-        .enable_8way = DT_INST_PROP_OR(n, enable_8way, false),                      \
-        .patterns = gesture_patterns,                                               \
-        .pattern_count = PATTERN_COUNT,                                             \
+        .quantizer = GESTURE_QUANTIZER(n),                                          \
+        .frame_sync = DT_INST_PROP(n, frame_sync),                                  \
+        .decimation_us = DT_INST_PROP(n, max_report_rate) > 0                       \
+                             ? 1000000 / DT_INST_PROP(n, max_report_rate)           \
+                             : 0,                                                   \
+        .loop_guard_rate = DT_INST_PROP(n, loop_guard_rate),                        \
+        .consume_motion = DT_INST_PROP(n, consume_motion),                          \
+        .replay_motion = DT_INST_PROP(n, replay_unmatched_motion),                  \
+        .patterns = gesture_patterns_##n,                                           \
+        .pattern_count = PATTERN_COUNT(n),                                          \
+        .matcher = &gesture_matcher_##n,                                            \
+        .press_spacing_ms = DT_INST_PROP(n, press_spacing_ms),                      \
+        .hold_time_ms = DT_INST_PROP(n, hold_time_ms),                              \
+        .commit_timeout_ms = DT_INST_PROP(n, commit_timeout_ms),                    \
+        .max_edits = DT_INST_PROP(n, max_edits),                                    \
+        GESTURE_SHAPE_CONFIG(n)                                                     \
+        .repeat_rate = DT_INST_PROP(n, repeat_rate),                                \
+        .repeat_burst = DT_INST_PROP(n, repeat_burst),                              \
     };                                                                              \
+    BUILD_ASSERT(DT_INST_PROP(n, repeat_rate) > 0, "repeat-rate must be positive"); \
+    BUILD_ASSERT(DT_INST_PROP(n, loop_guard_rate) > 0 &&                            \
+                     DT_INST_PROP(n, loop_guard_rate) <= 1000000,                   \
+                 "loop-guard-rate must be between 1 and 1000000");                  \
+    BUILD_ASSERT(DT_INST_PROP(n, max_report_rate) <= 1000000,                       \
+                 "max-report-rate must not exceed 1000000");                        \
+    BUILD_ASSERT(DT_INST_PROP(n, max_edits) == 0 ||                                 \
+                     IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_TOLERANT_MATCHING),        \
+                 "max-edits requires CONFIG_ZMK_MOUSE_GESTURE_TOLERANT_MATCHING");  \
+    BUILD_ASSERT(!DT_INST_PROP(n, replay_unmatched_motion) ||                       \
+                     DT_INST_PROP(n, consume_motion),                               \
+                 "replay-unmatched-motion requires consume-motion");                \
+    BUILD_ASSERT(DT_INST_PROP(n, flick_stroke_percent) <= 100,                      \
+                 "flick-stroke-percent must not exceed 100");                       \
+    BUILD_ASSERT(DT_INST_PROP(n, repeat_burst) > 0, "repeat-burst must be positive");\
+    BUILD_ASSERT(DT_INST_PROP(n, dead_zone_deg) * GESTURE_DIRECTIONS(n) < 360,      \
+                 "dead-zone-deg must be smaller than one direction sector");        \
     DEVICE_DT_INST_DEFINE(n, input_processor_mouse_gesture_init, NULL,              \
                           &input_processor_mouse_gesture_data_##n,                  \
                           &input_processor_mouse_gesture_config_##n, POST_KERNEL,   \
@@ -401,4 +1974,108 @@ static struct gesture_pattern *gesture_patterns[] = {DT_INST_FOREACH_CHILD(0, GE
 
 DT_INST_FOREACH_STATUS_OKAY(MOUSE_GESTURE_INPUT_PROCESSOR_INST)
 
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS) ||                                                 \
+    IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+#define GESTURE_DEVICE_ITEM(n) DEVICE_DT_INST_GET(n),
+
+static const struct device *const gesture_devices[] = {
+    DT_INST_FOREACH_STATUS_OKAY(GESTURE_DEVICE_ITEM)};
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+// Recognizes the samples of every processor in batches, each wake-up draining all rings
+static void gesture_recognizer_thread_main(void *p1, void *p2, void *p3) {
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (true) {
+        k_sem_take(&gesture_sample_sem, K_FOREVER);
+
+        for (size_t i = 0; i < ARRAY_SIZE(gesture_devices); i++) {
+            drain_samples(gesture_devices[i]);
+        }
+    }
+}
+
+K_THREAD_DEFINE(mouse_gesture_recognizer, CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD_STACK_SIZE,
+                gesture_recognizer_thread_main, NULL, NULL, NULL,
+                CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD_PRIORITY, 0, 0);
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_STATS)
+
+static void print_histogram(const struct shell *sh, const char *name, const char *unit,
+                            struct gesture_histogram *histogram) {
+    shell_print(sh, "  %s:", name);
+    for (size_t i = 0; i < GESTURE_HISTOGRAM_BUCKETS; i++) {
+        atomic_val_t count = atomic_get(&histogram->buckets[i]);
+        if (count == 0) {
+            continue;
+        }
+        if (i == GESTURE_HISTOGRAM_BUCKETS - 1) {
+            shell_print(sh, "    >= %u %s: %ld", (unsigned int)BIT(i), unit, (long)count);
+        } else {
+            shell_print(sh, "    < %u %s: %ld", (unsigned int)BIT(i + 1), unit, (long)count);
+        }
+    }
+}
+
+static int cmd_gesture_stats(const struct shell *sh, size_t argc, char **argv) {
+    for (size_t i = 0; i < ARRAY_SIZE(gesture_devices); i++) {
+        const struct device *dev = gesture_devices[i];
+        const struct input_processor_mouse_gesture_config *config = dev->config;
+        struct input_processor_mouse_gesture_data *data = dev->data;
+        struct gesture_stats *stats = &data->stats;
+
+        shell_print(sh, "%s:", dev->name);
+        shell_print(sh, "  events: %ld", (long)atomic_get(&stats->events));
+        shell_print(sh, "  below threshold: %ld", (long)atomic_get(&stats->below_threshold));
+        shell_print(sh, "  owner hand-offs: %ld", (long)atomic_get(&stats->handoffs));
+        shell_print(sh, "  cooldown rejects: %ld", (long)atomic_get(&stats->cooldown_rejects));
+        shell_print(sh, "  accumulator overflows: %ld",
+                    (long)atomic_get(&stats->accumulator_overflows));
+        shell_print(sh, "  sequence overflows: %ld", (long)atomic_get(&stats->sequence_overflows));
+        shell_print(sh, "  loop guard trips: %ld", (long)atomic_get(&stats->loop_guard_trips));
+        shell_print(sh, "  decimated: %ld", (long)atomic_get(&stats->decimated));
+        shell_print(sh, "  execution queue overflows: %ld",
+                    (long)atomic_get(&data->deferred_queue.overflows));
+#if IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)
+        shell_print(sh, "  sample ring overflows: %ld",
+                    (long)atomic_get(&data->sample_ring.overflows));
+#endif
+        shell_print(sh, "  work submit failures: %ld", (long)atomic_get(&stats->submit_failures));
+        shell_print(sh, "  split report failures: %ld",
+                    (long)atomic_get(&stats->split_report_failures));
+        shell_print(sh, "  repeats: %ld", (long)atomic_get(&stats->repeats));
+        shell_print(sh, "  repeats throttled: %ld", (long)atomic_get(&stats->repeat_throttled));
+        shell_print(sh, "  motion recognized: %ld, %ld", (long)atomic_get(&stats->motion_x),
+                    (long)atomic_get(&stats->motion_y));
+
+        // Fed and not drained yet, so fed motion = recognized + pending
+        long pending_x = 0;
+        long pending_y = 0;
+        for (size_t s = 0; s < GESTURE_SOURCES; s++) {
+            pending_x += (long)(atomic_get(&data->sources[s].pending_x) +
+                                atomic_get(&data->sources[s].frame_x));
+            pending_y += (long)(atomic_get(&data->sources[s].pending_y) +
+                                atomic_get(&data->sources[s].frame_y));
+        }
+        shell_print(sh, "  motion pending: %ld, %ld", pending_x, pending_y);
+
+        for (size_t p = 0; p < config->pattern_count; p++) {
+            shell_print(sh, "  pattern %zu hits: %ld", p, (long)atomic_get(&stats->pattern_hits[p]));
+        }
+
+        print_histogram(sh, "stroke duration", "ms", &stats->stroke_ms);
+        print_histogram(sh, "match-to-press latency", "us", &stats->latency_us);
+    }
+
+    return 0;
+}
+
+SHELL_SUBCMD_ADD((gesture), stats, NULL, "Show gesture recognizer statistics", cmd_gesture_stats,
+                 1, 0);
+#endif
+
 #endif
\ No newline at end of file
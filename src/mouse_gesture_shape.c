@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+
+#include <zmk/mouse_gesture_shape.h>
+
+// Sub-unit precision of resampled points, as a power of two
+#define SHAPE_FRACTION_BITS 4
+
+// Walks a path and yields points at equal arc length intervals, without a point buffer
+struct resampler {
+    const int32_t *xy;
+    size_t count;
+    size_t out_count;
+    int64_t total;      // Path length
+    size_t segment;     // Current segment, from point `segment` to `segment + 1`
+    int64_t seg_start;  // Arc length at the start of the current segment
+    int64_t seg_len;
+    size_t next;        // Index of the next sample
+};
+
+static uint32_t isqrt64(uint64_t value) {
+    if (value == 0) {
+        return 0;
+    }
+
+    // Start at the highest even power of two not above the value
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << ((63 - __builtin_clzll(value)) & ~1);
+
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+static int64_t coord(const int32_t *xy, size_t point, size_t axis) {
+    return (int64_t)xy[2 * point + axis] << SHAPE_FRACTION_BITS;
+}
+
+static int64_t segment_length(const int32_t *xy, size_t segment) {
+    int64_t dx = coord(xy, segment + 1, 0) - coord(xy, segment, 0);
+    int64_t dy = coord(xy, segment + 1, 1) - coord(xy, segment, 1);
+
+    return isqrt64((uint64_t)(dx * dx + dy * dy));
+}
+
+static int64_t path_length(const int32_t *xy, size_t count) {
+    int64_t total = 0;
+
+    for (size_t i = 0; i + 1 < count; i++) {
+        total += segment_length(xy, i);
+    }
+
+    return total;
+}
+
+static void resampler_start(struct resampler *r, const int32_t *xy, size_t count,
+                            size_t out_count, int64_t total) {
+    r->xy = xy;
+    r->count = count;
+    r->out_count = out_count;
+    r->total = total;
+    r->segment = 0;
+    r->seg_start = 0;
+    r->seg_len = count > 1 ? segment_length(xy, 0) : 0;
+    r->next = 0;
+}
+
+// Next resampled point, with SHAPE_FRACTION_BITS of fraction
+static void resampler_next(struct resampler *r, int64_t *x, int64_t *y) {
+    int64_t target = r->total * (int64_t)r->next / (int64_t)(r->out_count - 1);
+
+    r->next++;
+
+    while (r->segment + 2 < r->count && r->seg_start + r->seg_len < target) {
+        r->seg_start += r->seg_len;
+        r->segment++;
+        r->seg_len = segment_length(r->xy, r->segment);
+    }
+
+    size_t from = r->segment;
+    size_t to = r->count > 1 ? r->segment + 1 : r->segment;
+    int64_t along = target - r->seg_start;
+
+    if (r->seg_len == 0 || along <= 0) {
+        *x = coord(r->xy, from, 0);
+        *y = coord(r->xy, from, 1);
+    } else if (along >= r->seg_len) {
+        *x = coord(r->xy, to, 0);
+        *y = coord(r->xy, to, 1);
+    } else {
+        int64_t from_x = coord(r->xy, from, 0);
+        int64_t from_y = coord(r->xy, from, 1);
+        *x = from_x + (coord(r->xy, to, 0) - from_x) * along / r->seg_len;
+        *y = from_y + (coord(r->xy, to, 1) - from_y) * along / r->seg_len;
+    }
+}
+
+/*
+ * Three passes over the resampled path keep memory at the size of the output: the
+ * first finds the centroid, the second the extent after rotation, the third writes
+ * the scaled points. Rotation uses the centroid-to-first-point vector itself as
+ * cosine and sine, so no trigonometry is needed.
+ */
+int zmk_gesture_shape_normalize(const int32_t *xy, size_t count,
+                                struct zmk_gesture_shape_point *out, size_t out_count) {
+    struct resampler r;
+    int64_t x, y;
+
+    if (count < 2 || out_count < 2) {
+        return -EINVAL;
+    }
+
+    int64_t total = path_length(xy, count);
+    int64_t sum_x = 0;
+    int64_t sum_y = 0;
+    resampler_start(&r, xy, count, out_count, total);
+    for (size_t i = 0; i < out_count; i++) {
+        resampler_next(&r, &x, &y);
+        sum_x += x;
+        sum_y += y;
+    }
+
+    int64_t cx = sum_x / (int64_t)out_count;
+    int64_t cy = sum_y / (int64_t)out_count;
+    int64_t vx = coord(xy, 0, 0) - cx;
+    int64_t vy = coord(xy, 0, 1) - cy;
+    int64_t len = isqrt64((uint64_t)(vx * vx + vy * vy));
+
+    if (len == 0) {
+        vx = 1;
+        vy = 0;
+        len = 1;
+    }
+
+    int64_t min_x = INT64_MAX, max_x = INT64_MIN;
+    int64_t min_y = INT64_MAX, max_y = INT64_MIN;
+    resampler_start(&r, xy, count, out_count, total);
+    for (size_t i = 0; i < out_count; i++) {
+        resampler_next(&r, &x, &y);
+        int64_t rx = ((x - cx) * vx + (y - cy) * vy) / len;
+        int64_t ry = ((y - cy) * vx - (x - cx) * vy) / len;
+        min_x = rx < min_x ? rx : min_x;
+        max_x = rx > max_x ? rx : max_x;
+        min_y = ry < min_y ? ry : min_y;
+        max_y = ry > max_y ? ry : max_y;
+    }
+
+    // Uniform scale, so straight lines keep their proportions instead of blowing up
+    int64_t extent = max_x - min_x > max_y - min_y ? max_x - min_x : max_y - min_y;
+    if (extent == 0) {
+        return -EINVAL;
+    }
+
+    resampler_start(&r, xy, count, out_count, total);
+    for (size_t i = 0; i < out_count; i++) {
+        resampler_next(&r, &x, &y);
+        int64_t rx = ((x - cx) * vx + (y - cy) * vy) / len;
+        int64_t ry = ((y - cy) * vx - (x - cx) * vy) / len;
+        out[i].x = (int16_t)(rx * ZMK_GESTURE_SHAPE_SIZE / extent);
+        out[i].y = (int16_t)(ry * ZMK_GESTURE_SHAPE_SIZE / extent);
+    }
+
+    return 0;
+}
+
+uint32_t zmk_gesture_shape_distance(const struct zmk_gesture_shape_point *a,
+                                    const struct zmk_gesture_shape_point *b, size_t count) {
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        int32_t dx = a[i].x - b[i].x;
+        int32_t dy = a[i].y - b[i].y;
+        sum += isqrt64((uint64_t)((int64_t)dx * dx + (int64_t)dy * dy));
+    }
+
+    return (uint32_t)(sum * 1000 / (count * ZMK_GESTURE_SHAPE_SIZE));
+}
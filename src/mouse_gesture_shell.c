@@ -0,0 +1,11 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/shell/shell.h>
+
+// Root `gesture` command, subcommands are added by the features that provide them
+SHELL_SUBCMD_SET_CREATE(gesture_cmds, (gesture));
+SHELL_CMD_REGISTER(gesture, &gesture_cmds, "Mouse gesture commands", NULL);
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/input/input.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/mouse_gesture_trace.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define TRACE_BUFFER_SIZE CONFIG_ZMK_MOUSE_GESTURE_TRACE_BUFFER_SIZE
+
+// Longest record: 5-byte time varint, tag, 5-byte value varint
+#define TRACE_MAX_RECORD_SIZE 11
+
+BUILD_ASSERT(TRACE_BUFFER_SIZE >= TRACE_MAX_RECORD_SIZE,
+             "Trace buffer must hold at least one record");
+
+#define TRACE_DUMP_BYTES_PER_LINE 32
+
+struct trace_buffer {
+    struct k_spinlock lock;
+    uint8_t data[TRACE_BUFFER_SIZE];
+    size_t head;   // Next byte to write
+    size_t tail;   // First byte of the oldest record
+    size_t used;   // Bytes between tail and head
+    int64_t last_ticks;
+    bool empty;
+    bool dumping;  // Recording pauses while the shell reads the buffer
+};
+
+static struct trace_buffer trace = {
+    .empty = true,
+};
+
+static size_t put_varint(uint8_t *out, uint32_t value) {
+    size_t len = 0;
+
+    while (value >= 0x80) {
+        out[len++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    out[len++] = (uint8_t)value;
+
+    return len;
+}
+
+static uint8_t byte_at(size_t offset) {
+    return trace.data[(trace.tail + offset) % TRACE_BUFFER_SIZE];
+}
+
+// Length of the oldest record, decoded in place (called with the lock held)
+static size_t oldest_record_size(void) {
+    size_t len = 0;
+
+    while (byte_at(len++) & 0x80) {
+    }
+
+    uint8_t tag = byte_at(len++);
+    uint8_t kind = tag & MOUSE_GESTURE_TRACE_KIND_MASK;
+
+    if (kind == MOUSE_GESTURE_TRACE_KIND_REL_X || kind == MOUSE_GESTURE_TRACE_KIND_REL_Y) {
+        while (byte_at(len++) & 0x80) {
+        }
+    }
+
+    return len;
+}
+
+static void trace_append(uint8_t tag, bool has_value, int32_t value) {
+    uint8_t record[TRACE_MAX_RECORD_SIZE];
+    k_spinlock_key_t key = k_spin_lock(&trace.lock);
+
+    if (trace.dumping) {
+        k_spin_unlock(&trace.lock, key);
+        return;
+    }
+
+    int64_t now = k_uptime_ticks();
+    uint64_t delta_us = trace.empty ? 0 : k_ticks_to_us_floor64(now - trace.last_ticks);
+
+    size_t len = put_varint(record, (uint32_t)MIN(delta_us, UINT32_MAX));
+    record[len++] = tag;
+    if (has_value) {
+        // Zigzag so small negative values stay short
+        len += put_varint(&record[len], ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+    }
+
+    // Make room by dropping whole records from the old end
+    while (TRACE_BUFFER_SIZE - trace.used < len) {
+        size_t dropped = oldest_record_size();
+        trace.tail = (trace.tail + dropped) % TRACE_BUFFER_SIZE;
+        trace.used -= dropped;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        trace.data[trace.head] = record[i];
+        trace.head = (trace.head + 1) % TRACE_BUFFER_SIZE;
+    }
+    trace.used += len;
+    trace.last_ticks = now;
+    trace.empty = false;
+
+    k_spin_unlock(&trace.lock, key);
+}
+
+void zmk_mouse_gesture_trace_motion(uint16_t code, int32_t value, bool sync) {
+    uint8_t tag = code == INPUT_REL_X ? MOUSE_GESTURE_TRACE_KIND_REL_X
+                                      : MOUSE_GESTURE_TRACE_KIND_REL_Y;
+
+    if (sync) {
+        tag |= MOUSE_GESTURE_TRACE_SYNC;
+    }
+
+    trace_append(tag, true, value);
+}
+
+void zmk_mouse_gesture_trace_activation(bool active) {
+    trace_append(active ? MOUSE_GESTURE_TRACE_KIND_ACTIVATE : MOUSE_GESTURE_TRACE_KIND_DEACTIVATE,
+                 false, 0);
+}
+
+static int cmd_trace_dump(const struct shell *sh, size_t argc, char **argv) {
+    uint8_t line[TRACE_DUMP_BYTES_PER_LINE];
+    char hex[TRACE_DUMP_BYTES_PER_LINE * 2 + 1];
+
+    k_spinlock_key_t key = k_spin_lock(&trace.lock);
+    trace.dumping = true;
+    size_t used = trace.used;
+    k_spin_unlock(&trace.lock, key);
+
+    // Plain hex lines for scripts/decode_gesture_trace.py
+    shell_print(sh, "gesture-trace v%d %zu", MOUSE_GESTURE_TRACE_VERSION, used);
+
+    for (size_t offset = 0; offset < used; offset += sizeof(line)) {
+        size_t count = MIN(used - offset, sizeof(line));
+
+        for (size_t i = 0; i < count; i++) {
+            line[i] = byte_at(offset + i);
+        }
+
+        bin2hex(line, count, hex, sizeof(hex));
+        shell_print(sh, "%s", hex);
+    }
+
+    shell_print(sh, "gesture-trace end");
+
+    key = k_spin_lock(&trace.lock);
+    trace.dumping = false;
+    k_spin_unlock(&trace.lock, key);
+
+    return 0;
+}
+
+static int cmd_trace_clear(const struct shell *sh, size_t argc, char **argv) {
+    k_spinlock_key_t key = k_spin_lock(&trace.lock);
+    trace.head = 0;
+    trace.tail = 0;
+    trace.used = 0;
+    trace.empty = true;
+    k_spin_unlock(&trace.lock, key);
+
+    shell_print(sh, "Gesture trace cleared");
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(gesture_trace_cmds,
+                               SHELL_CMD(dump, NULL, "Dump the motion trace", cmd_trace_dump),
+                               SHELL_CMD(clear, NULL, "Clear the motion trace", cmd_trace_clear),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_SUBCMD_ADD((gesture), trace, &gesture_trace_cmds, "Motion trace recorder", NULL, 1, 0);
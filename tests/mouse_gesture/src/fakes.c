@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/timing/timing.h>
+
+#include <zmk/behavior.h>
+#include <zmk/behavior_queue.h>
+
+#include "fakes.h"
+
+LOG_MODULE_REGISTER(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+static struct k_spinlock calls_lock;
+static struct gesture_test_call calls[GESTURE_TEST_MAX_CALLS];
+static size_t call_count;
+static timing_t input_mark;
+
+// Stand-ins for the pointing devices, the processor only uses them as identities
+DEVICE_DEFINE(gesture_test_input_a, "test_input_a", NULL, NULL, NULL, NULL, POST_KERNEL,
+              CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, NULL);
+DEVICE_DEFINE(gesture_test_input_b, "test_input_b", NULL, NULL, NULL, NULL, POST_KERNEL,
+              CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, NULL);
+DEVICE_DEFINE(gesture_test_input_c, "test_input_c", NULL, NULL, NULL, NULL, POST_KERNEL,
+              CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, NULL);
+
+const struct device *const gesture_test_inputs[3] = {
+    DEVICE_GET(gesture_test_input_a),
+    DEVICE_GET(gesture_test_input_b),
+    DEVICE_GET(gesture_test_input_c),
+};
+
+static void record_call(const struct zmk_behavior_binding *binding, bool pressed, bool queued,
+                        uint32_t wait) {
+    timing_t now = timing_counter_get();
+    k_spinlock_key_t key = k_spin_lock(&calls_lock);
+
+    if (call_count < GESTURE_TEST_MAX_CALLS) {
+        calls[call_count] = (struct gesture_test_call){
+            .param = binding->param1,
+            .pressed = pressed,
+            .queued = queued,
+            .wait = wait,
+            .latency_ns = timing_cycles_to_ns(timing_cycles_get(&input_mark, &now)),
+        };
+    }
+    call_count++;
+
+    k_spin_unlock(&calls_lock, key);
+}
+
+void gesture_test_calls_reset(void) {
+    k_spinlock_key_t key = k_spin_lock(&calls_lock);
+    call_count = 0;
+    k_spin_unlock(&calls_lock, key);
+}
+
+size_t gesture_test_calls(struct gesture_test_call *out, size_t max) {
+    k_spinlock_key_t key = k_spin_lock(&calls_lock);
+    size_t count = call_count;
+
+    memcpy(out, calls, MIN(MIN(count, max), GESTURE_TEST_MAX_CALLS) * sizeof(*out));
+    k_spin_unlock(&calls_lock, key);
+    return count;
+}
+
+size_t gesture_test_presses(uint32_t *params, size_t max) {
+    k_spinlock_key_t key = k_spin_lock(&calls_lock);
+    size_t presses = 0;
+
+    for (size_t i = 0; i < MIN(call_count, GESTURE_TEST_MAX_CALLS); i++) {
+        if (!calls[i].pressed) {
+            continue;
+        }
+        if (presses < max) {
+            params[presses] = calls[i].param;
+        }
+        presses++;
+    }
+
+    k_spin_unlock(&calls_lock, key);
+    return presses;
+}
+
+void gesture_test_mark_input(void) {
+    timing_t now = timing_counter_get();
+    k_spinlock_key_t key = k_spin_lock(&calls_lock);
+    input_mark = now;
+    k_spin_unlock(&calls_lock, key);
+}
+
+// ZMK fakes. Behaviors resolve by device name like in ZMK; gesture bindings are recorded
+// instead of being executed.
+
+const struct device *zmk_behavior_get_binding(const char *name) {
+    return device_get_binding(name);
+}
+
+int zmk_behavior_invoke_binding(const struct zmk_behavior_binding *src_binding,
+                                struct zmk_behavior_binding_event event, bool pressed) {
+    record_call(src_binding, pressed, false, 0);
+    return 0;
+}
+
+int zmk_behavior_queue_add(const struct zmk_behavior_binding_event *event,
+                           const struct zmk_behavior_binding behavior, bool press, uint32_t wait) {
+    record_call(&behavior, press, true, wait);
+    return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/timing/timing.h>
+
+#define GESTURE_TEST_MAX_CALLS 256
+
+// One binding handed to the behavior queue or invoked directly by the processor
+struct gesture_test_call {
+    uint32_t param;      // param1 of the recorder binding, identifies the gesture
+    bool pressed;
+    bool queued;         // Through zmk_behavior_queue_add() rather than invoked directly
+    uint32_t wait;       // Behavior queue delay after the call
+    uint64_t latency_ns; // Since the last event fed with gesture_test_mark_input()
+};
+
+// Input devices the tests feed motion from, each claims its own gesture source
+extern const struct device *const gesture_test_inputs[3];
+
+/**
+ * @brief Forget all recorded calls
+ */
+void gesture_test_calls_reset(void);
+
+/**
+ * @brief Copy the recorded calls
+ *
+ * @return Number of calls recorded, which may exceed max
+ */
+size_t gesture_test_calls(struct gesture_test_call *calls, size_t max);
+
+/**
+ * @brief Copy the gestures of the recorded presses, in order
+ *
+ * @return Number of presses recorded, which may exceed max
+ */
+size_t gesture_test_presses(uint32_t *params, size_t max);
+
+/**
+ * @brief Note that an input event is about to be fed, latencies are measured from here
+ */
+void gesture_test_mark_input(void);
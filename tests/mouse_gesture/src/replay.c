@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/input/input.h>
+#include <zephyr/kernel.h>
+#include <zephyr/timing/timing.h>
+
+#include <drivers/behavior.h>
+#include <drivers/input_processor.h>
+#include <zmk/behavior.h>
+
+#include "fakes.h"
+#include "replay.h"
+
+#define GESTURE_KEY DT_NODELABEL(gesture_key)
+
+void gesture_test_activate(bool active) {
+    struct zmk_behavior_binding binding = {
+        .behavior_dev = DEVICE_DT_NAME(GESTURE_KEY),
+    };
+    struct zmk_behavior_binding_event event = {
+        .position = 0,
+        .timestamp = k_uptime_get(),
+    };
+
+    if (active) {
+        behavior_keymap_binding_pressed(&binding, event);
+    } else {
+        behavior_keymap_binding_released(&binding, event);
+    }
+}
+
+int gesture_test_event(const struct device *processor, const struct device *input, uint16_t code,
+                       int32_t value, bool sync, struct gesture_replay_stats *stats) {
+    struct input_event event = {
+        .dev = input,
+        .sync = sync,
+        .type = INPUT_EV_REL,
+        .code = code,
+        .value = value,
+    };
+    struct zmk_input_processor_state state = {0};
+
+    gesture_test_mark_input();
+
+    timing_t start = timing_counter_get();
+    int ret = zmk_input_processor_handle_event(processor, &event, 0, 0, &state);
+    timing_t end = timing_counter_get();
+
+    if (stats != NULL) {
+        uint64_t cycles = timing_cycles_get(&start, &end);
+
+        stats->events++;
+        stats->cycles += cycles;
+        stats->max_cycles = MAX(stats->max_cycles, cycles);
+    }
+
+    return ret;
+}
+
+void gesture_test_stroke(const struct device *processor, const struct device *input,
+                         int32_t dx, int32_t dy, int reports, struct gesture_replay_stats *stats) {
+    static uint32_t seed = 1;
+
+    for (int i = 0; i < reports; i++) {
+        // +/-2 counts of jitter on each axis, below the movement threshold on its own
+        seed = seed * 1103515245 + 12345;
+        int32_t jitter_x = (int32_t)((seed >> 16) % 5) - 2;
+        int32_t jitter_y = (int32_t)((seed >> 24) % 5) - 2;
+
+        gesture_test_event(processor, input, INPUT_REL_X, dx + jitter_x, false, stats);
+        gesture_test_event(processor, input, INPUT_REL_Y, dy + jitter_y, true, stats);
+        k_sleep(K_MSEC(1));
+    }
+}
+
+// Parse one decoded trace line, `<time_us> <kind> [<value>] [sync]`
+static int replay_line(const struct device *processor, const struct device *input, char *line,
+                       uint32_t *last_us, struct gesture_replay_stats *stats) {
+    char *save;
+    char *time = strtok_r(line, " ", &save);
+    char *kind = strtok_r(NULL, " ", &save);
+
+    if (time == NULL || kind == NULL) {
+        return -EINVAL;
+    }
+
+    uint32_t time_us = strtoul(time, NULL, 10);
+    if (time_us > *last_us) {
+        k_sleep(K_USEC(time_us - *last_us));
+        *last_us = time_us;
+    }
+
+    if (strcmp(kind, "ACTIVATE") == 0 || strcmp(kind, "DEACTIVATE") == 0) {
+        gesture_test_activate(kind[0] == 'A');
+        return 0;
+    }
+
+    bool is_x = strcmp(kind, "REL_X") == 0;
+    if (!is_x && strcmp(kind, "REL_Y") != 0) {
+        return -EINVAL;
+    }
+
+    char *value = strtok_r(NULL, " ", &save);
+    char *sync = strtok_r(NULL, " ", &save);
+    if (value == NULL) {
+        return -EINVAL;
+    }
+
+    gesture_test_event(processor, input, is_x ? INPUT_REL_X : INPUT_REL_Y, strtol(value, NULL, 10),
+                       sync != NULL && strcmp(sync, "sync") == 0, stats);
+    return 0;
+}
+
+// `# expect <id>...` comment listing the gestures a trace fires
+static int parse_expect(char *line, uint32_t *expected, int max) {
+    char *save;
+    char *word = strtok_r(line + 1, " ", &save);
+    int count = 0;
+
+    if (word == NULL || strcmp(word, "expect") != 0) {
+        return 0;
+    }
+
+    while ((word = strtok_r(NULL, " ", &save)) != NULL && count < max) {
+        expected[count++] = strtoul(word, NULL, 10);
+    }
+
+    return count;
+}
+
+int gesture_replay(const struct device *processor, const struct device *input, const char *trace,
+                   uint32_t expected[GESTURE_TEST_MAX_EXPECTED],
+                   struct gesture_replay_stats *stats) {
+    char line[64];
+    uint32_t last_us = 0;
+    int expected_count = 0;
+
+    while (*trace != '\0') {
+        size_t len = strcspn(trace, "\r\n");
+
+        if (len >= sizeof(line)) {
+            return -EINVAL;
+        }
+
+        memcpy(line, trace, len);
+        line[len] = '\0';
+        trace += len;
+        trace += strspn(trace, "\r\n");
+
+        if (len == 0) {
+            continue;
+        }
+
+        if (line[0] == '#') {
+            expected_count += parse_expect(line, &expected[expected_count],
+                                           GESTURE_TEST_MAX_EXPECTED - expected_count);
+            continue;
+        }
+
+        int ret = replay_line(processor, input, line, &last_us, stats);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    return expected_count;
+}
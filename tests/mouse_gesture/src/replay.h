@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+
+#define GESTURE_TEST_MAX_EXPECTED 16
+
+// Trace embedded from traces/ by the build
+struct gesture_trace_file {
+    const char *name;
+    const char *text;
+};
+
+// Handler cost of the events fed so far
+struct gesture_replay_stats {
+    uint32_t events;
+    uint64_t cycles;
+    uint64_t max_cycles;
+};
+
+/**
+ * @brief Press or release the momentary gesture key
+ */
+void gesture_test_activate(bool active);
+
+/**
+ * @brief Feed one event through the processor's driver API, as an input listener would
+ *
+ * @return The processor's verdict, ZMK_INPUT_PROC_CONTINUE or ZMK_INPUT_PROC_STOP
+ */
+int gesture_test_event(const struct device *processor, const struct device *input, uint16_t code,
+                       int32_t value, bool sync, struct gesture_replay_stats *stats);
+
+/**
+ * @brief Draw a straight stroke as 1 kHz reports of (dx, dy), X and Y in one report
+ *
+ * A small deterministic jitter is added to both axes, like a real sensor.
+ */
+void gesture_test_stroke(const struct device *processor, const struct device *input,
+                         int32_t dx, int32_t dy, int reports, struct gesture_replay_stats *stats);
+
+/**
+ * @brief Replay a trace in the format printed by scripts/decode_gesture_trace.py
+ *
+ * Events keep their recorded spacing. Lines starting with `#` are comments, except
+ * `# expect <id>...`, which lists the gestures the trace should fire.
+ *
+ * @return Number of expected gestures stored in expected, or -EINVAL on a malformed line
+ */
+int gesture_replay(const struct device *processor, const struct device *input, const char *trace,
+                   uint32_t expected[GESTURE_TEST_MAX_EXPECTED],
+                   struct gesture_replay_stats *stats);
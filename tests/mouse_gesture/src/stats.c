@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/shell/shell_dummy.h>
+#include <zephyr/sys/util.h>
+
+#include "stats.h"
+
+void gesture_test_stats_init(void) {
+    const struct shell *sh = shell_backend_dummy_get_ptr();
+
+    WAIT_FOR(shell_ready(sh), 20000, k_msleep(1));
+}
+
+int gesture_test_stat(const struct device *processor, const char *name, long *values,
+                      size_t count) {
+    const struct shell *sh = shell_backend_dummy_get_ptr();
+    char label[64];
+    size_t size;
+
+    shell_backend_dummy_clear_output(sh);
+    if (shell_execute_cmd(sh, "gesture stats") != 0) {
+        return -ENOENT;
+    }
+    const char *output = shell_backend_dummy_get_output(sh, &size);
+
+    // Each processor's counters follow a "<name>:" line
+    snprintf(label, sizeof(label), "\n%s:", processor->name);
+    const char *section = strncmp(output, label + 1, strlen(label) - 1) == 0
+                              ? output
+                              : strstr(output, label);
+    if (section == NULL) {
+        return -ENOENT;
+    }
+
+    snprintf(label, sizeof(label), "  %s: ", name);
+    const char *line = strstr(section, label);
+    if (line == NULL) {
+        return -ENOENT;
+    }
+
+    const char *pos = line + strlen(label);
+    for (size_t i = 0; i < count; i++) {
+        char *end;
+
+        values[i] = strtol(pos, &end, 10);
+        if (end == pos) {
+            return -ENOENT;
+        }
+        pos = *end == ',' ? end + 1 : end;
+    }
+
+    return 0;
+}
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <zephyr/device.h>
+
+/**
+ * @brief Wait for the shell the counters are read through
+ */
+void gesture_test_stats_init(void);
+
+/**
+ * @brief Read a counter of a processor from the output of `gesture stats`
+ *
+ * @param name Counter as labelled by the shell, e.g. "decimated"
+ * @param values Receives the comma separated values of the counter
+ * @param count Values expected
+ *
+ * @return 0 on success, -ENOENT if the processor or counter is not listed
+ */
+int gesture_test_stat(const struct device *processor, const char *name, long *values,
+                      size_t count);
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/input/input.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "fakes.h"
+#include "replay.h"
+#include "stats.h"
+
+#define HAMMER DEVICE_DT_GET(DT_NODELABEL(gestures_hammer))
+
+// Gesture ids of gestures_hammer in the overlay
+enum {
+    HAMMER_RIGHT = 10,
+    HAMMER_RIGHT_UP = 11,
+};
+
+#define HAMMER_THREADS 4
+#define HAMMER_ROUNDS 48
+#define HAMMER_STROKE 64  // stroke-size of gestures_hammer
+#define HAMMER_STACK_SIZE 2048
+
+// Longer than commit-timeout-ms and the flush, so every gesture has fired
+#define SETTLE_TIME K_MSEC(100)
+
+static K_THREAD_STACK_ARRAY_DEFINE(hammer_stacks, HAMMER_THREADS, HAMMER_STACK_SIZE);
+static struct k_thread hammer_threads[HAMMER_THREADS];
+static struct k_sem round_start[HAMMER_THREADS];
+static K_SEM_DEFINE(round_done, 0, HAMMER_THREADS);
+static volatile int round_code;  // Axis fed in this round, -1 to stop
+
+// Feeds its share of each round as +1 deltas, so the round adds up to exactly one stroke
+// whatever the interleaving
+static void hammer_main(void *p1, void *p2, void *p3) {
+    struct k_sem *start = p1;
+
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (true) {
+        k_sem_take(start, K_FOREVER);
+        int code = round_code;
+        if (code < 0) {
+            return;
+        }
+
+        for (int i = 0; i < HAMMER_STROKE / HAMMER_THREADS; i++) {
+            gesture_test_event(HAMMER, gesture_test_inputs[0], code, 1, code == INPUT_REL_Y,
+                               NULL);
+            if (i % 8 == 7) {
+                // Let time pass, so the flush and commit timers expire mid-round
+                k_busy_wait(300);
+            } else {
+                k_yield();
+            }
+        }
+
+        k_sem_give(&round_done);
+    }
+}
+
+static void check_motion(const long fed[2], const long base[2]) {
+    long recognized[2];
+    long pending[2];
+
+    zassert_ok(gesture_test_stat(HAMMER, "motion recognized", recognized, 2));
+    zassert_ok(gesture_test_stat(HAMMER, "motion pending", pending, 2));
+
+    for (int axis = 0; axis < 2; axis++) {
+        zassert_equal(recognized[axis] - base[axis] + pending[axis], fed[axis],
+                      "Axis %d: fed %ld, recognized %ld, pending %ld", axis, fed[axis],
+                      recognized[axis] - base[axis], pending[axis]);
+    }
+}
+
+ZTEST(mouse_gesture_concurrency, test_hammer) {
+    uint32_t presses[GESTURE_TEST_MAX_CALLS];
+    long base[2];
+    long fed[2] = {0, 0};
+    long handoffs[2];
+    size_t rights = 0;
+
+    // The sample ring has a single producer, the input thread
+    if (IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)) {
+        ztest_test_skip();
+    }
+
+    zassert_ok(gesture_test_stat(HAMMER, "motion recognized", base, 2));
+    zassert_ok(gesture_test_stat(HAMMER, "owner hand-offs", &handoffs[0], 1));
+
+    for (size_t t = 0; t < HAMMER_THREADS; t++) {
+        k_sem_init(&round_start[t], 0, 1);
+        k_thread_create(&hammer_threads[t], hammer_stacks[t],
+                        K_THREAD_STACK_SIZEOF(hammer_stacks[t]), hammer_main, &round_start[t],
+                        NULL, NULL, K_PRIO_PREEMPT(5), 0, K_NO_WAIT);
+    }
+
+    gesture_test_activate(true);
+
+    // Alternate right and down, so each axis only grows and a lost delta shows. Pairs of
+    // rounds alternate between a gap shorter and longer than commit-timeout-ms, so the right
+    // stroke is committed by the diverging down stroke or by the commit work.
+    for (int round = 0; round < HAMMER_ROUNDS; round++) {
+        bool right = round % 2 == 0;
+
+        round_code = right ? INPUT_REL_X : INPUT_REL_Y;
+        for (size_t t = 0; t < HAMMER_THREADS; t++) {
+            k_sem_give(&round_start[t]);
+        }
+        for (size_t t = 0; t < HAMMER_THREADS; t++) {
+            k_sem_take(&round_done, K_FOREVER);
+        }
+
+        fed[right ? 0 : 1] += HAMMER_STROKE;
+        rights += right;
+        check_motion(fed, base);
+
+        k_msleep((round / 2) % 2 ? 8 : 2);
+    }
+
+    round_code = -1;
+    for (size_t t = 0; t < HAMMER_THREADS; t++) {
+        k_sem_give(&round_start[t]);
+        k_thread_join(&hammer_threads[t], K_FOREVER);
+    }
+
+    k_sleep(SETTLE_TIME);
+    gesture_test_activate(false);
+    k_sleep(SETTLE_TIME);
+
+    // Everything posted has been drained by a recognizer
+    long pending[2];
+    zassert_ok(gesture_test_stat(HAMMER, "motion pending", pending, 2));
+    zassert_true(pending[0] == 0 && pending[1] == 0, "Motion left pending: %ld, %ld",
+                 pending[0], pending[1]);
+    check_motion(fed, base);
+
+    zassert_ok(gesture_test_stat(HAMMER, "owner hand-offs", &handoffs[1], 1));
+    TC_PRINT("  %d rounds, %ld owner hand-offs\n", HAMMER_ROUNDS, handoffs[1] - handoffs[0]);
+
+    // One right per right round, and never the longer pattern
+    size_t count = gesture_test_presses(presses, ARRAY_SIZE(presses));
+    zassert_equal(count, rights, "Expected %zu gestures, got %zu", rights, count);
+    for (size_t i = 0; i < MIN(count, ARRAY_SIZE(presses)); i++) {
+        zassert_equal(presses[i], HAMMER_RIGHT, "Unexpected gesture %u", presses[i]);
+    }
+}
+
+static void *concurrency_setup(void) {
+    gesture_test_stats_init();
+    return NULL;
+}
+
+static void concurrency_before(void *fixture) {
+    ARG_UNUSED(fixture);
+
+    gesture_test_activate(false);
+    k_sleep(SETTLE_TIME);
+    gesture_test_calls_reset();
+}
+
+ZTEST_SUITE(mouse_gesture_concurrency, NULL, concurrency_setup, concurrency_before, NULL, NULL);
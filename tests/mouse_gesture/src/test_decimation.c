@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/input/input.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/timing/timing.h>
+#include <zephyr/ztest.h>
+
+#include "fakes.h"
+#include "replay.h"
+#include "stats.h"
+
+#define DECIMATED DEVICE_DT_GET(DT_NODELABEL(gestures_decimated))
+#define LOOP DEVICE_DT_GET(DT_NODELABEL(gestures_loop))
+
+// Gesture id of gestures_decimated in the overlay
+#define DECIMATED_LEFT 20
+
+// Longer than gesture-cooldown-ms, so every gesture has fired and the next may start
+#define SETTLE_TIME K_MSEC(500)
+
+ZTEST(mouse_gesture_decimation, test_high_rate_sensor) {
+    struct gesture_replay_stats stats = {0};
+    uint32_t presses[2];
+    long decimated[2];
+    long trips[2];
+
+    zassert_ok(gesture_test_stat(DECIMATED, "decimated", &decimated[0], 1));
+    zassert_ok(gesture_test_stat(DECIMATED, "loop guard trips", &trips[0], 1));
+
+    // 8 kHz reports of 2 counts, each below movement-threshold on its own
+    gesture_test_activate(true);
+    for (int i = 0; i < 200; i++) {
+        gesture_test_event(DECIMATED, gesture_test_inputs[0], INPUT_REL_X, -2, true, &stats);
+        k_busy_wait(125);
+    }
+    k_sleep(SETTLE_TIME);
+    gesture_test_activate(false);
+
+    zassert_ok(gesture_test_stat(DECIMATED, "decimated", &decimated[1], 1));
+    zassert_ok(gesture_test_stat(DECIMATED, "loop guard trips", &trips[1], 1));
+
+    long merged = decimated[1] - decimated[0];
+    TC_PRINT("  %u events, %ld merged into later passes, avg %llu ns\n", stats.events, merged,
+             (unsigned long long)timing_cycles_to_ns(stats.cycles / MAX(stats.events, 1)));
+
+    // 25 ms of reports allow about 7 passes
+    zassert_true(merged >= (long)stats.events - 16, "Only %ld of %u events merged", merged,
+                 stats.events);
+    zassert_equal(trips[1], trips[0], "Loop guard tripped");
+
+    size_t count = gesture_test_presses(presses, ARRAY_SIZE(presses));
+    zassert_equal(count, 1, "Expected 1 gesture, got %zu", count);
+    zassert_equal(presses[0], DECIMATED_LEFT, "Merged motion misrecognized");
+}
+
+ZTEST(mouse_gesture_decimation, test_flush_recognizes_the_tail) {
+    uint32_t presses[2];
+
+    // The first report is recognized at once, the rest of the stroke arrives within the
+    // same decimation interval and waits for the flush
+    gesture_test_activate(true);
+    for (int i = 0; i < 15; i++) {
+        gesture_test_event(DECIMATED, gesture_test_inputs[0], INPUT_REL_X, -20, true, NULL);
+    }
+
+    zassert_equal(gesture_test_presses(presses, ARRAY_SIZE(presses)), 0,
+                  "Merged motion recognized before the flush");
+
+    k_sleep(K_MSEC(20));
+    size_t count = gesture_test_presses(presses, ARRAY_SIZE(presses));
+    zassert_equal(count, 1, "Expected 1 gesture after the flush, got %zu", count);
+    zassert_equal(presses[0], DECIMATED_LEFT, "Flushed motion misrecognized");
+
+    gesture_test_activate(false);
+}
+
+ZTEST(mouse_gesture_decimation, test_release_recognizes_the_tail) {
+    uint32_t presses[2];
+
+    // Released within the decimation interval: the merged motion still belongs to the
+    // activation and is recognized by the deactivation commit, not dropped
+    gesture_test_activate(true);
+    for (int i = 0; i < 15; i++) {
+        gesture_test_event(DECIMATED, gesture_test_inputs[0], INPUT_REL_X, -20, true, NULL);
+    }
+    gesture_test_activate(false);
+
+    k_sleep(SETTLE_TIME);
+    size_t count = gesture_test_presses(presses, ARRAY_SIZE(presses));
+    zassert_equal(count, 1, "Expected 1 gesture after the release, got %zu", count);
+    zassert_equal(presses[0], DECIMATED_LEFT, "Released motion misrecognized");
+}
+
+ZTEST(mouse_gesture_decimation, test_loop_guard_trips_once) {
+    long trips[3];
+
+    zassert_ok(gesture_test_stat(LOOP, "loop guard trips", &trips[0], 1));
+
+    // 50 passes against a second's worth of 10 trip the guard once, not for every drop
+    gesture_test_activate(true);
+    for (int i = 0; i < 50; i++) {
+        gesture_test_event(LOOP, gesture_test_inputs[0], INPUT_REL_X, -1, true, NULL);
+    }
+    k_sleep(K_MSEC(1));  // Lets a recognizer thread drain the samples
+    zassert_ok(gesture_test_stat(LOOP, "loop guard trips", &trips[1], 1));
+    zassert_equal(trips[1] - trips[0], 1, "Loop guard counted %ld trips",
+                  trips[1] - trips[0]);
+
+    // Once a token is available again, the next burst is a new trip
+    k_sleep(K_MSEC(200));
+    for (int i = 0; i < 50; i++) {
+        gesture_test_event(LOOP, gesture_test_inputs[0], INPUT_REL_X, -1, true, NULL);
+    }
+    k_sleep(K_MSEC(1));
+    gesture_test_activate(false);
+    zassert_ok(gesture_test_stat(LOOP, "loop guard trips", &trips[2], 1));
+    zassert_equal(trips[2] - trips[1], 1, "Loop guard counted %ld trips",
+                  trips[2] - trips[1]);
+}
+
+static void *decimation_setup(void) {
+    gesture_test_stats_init();
+    return NULL;
+}
+
+static void decimation_before(void *fixture) {
+    ARG_UNUSED(fixture);
+
+    gesture_test_activate(false);
+    k_sleep(SETTLE_TIME);
+    gesture_test_calls_reset();
+}
+
+ZTEST_SUITE(mouse_gesture_decimation, NULL, decimation_setup, decimation_before, NULL, NULL);
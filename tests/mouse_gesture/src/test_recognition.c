@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/timing/timing.h>
+#include <zephyr/ztest.h>
+
+#include "fakes.h"
+#include "replay.h"
+
+#include <gesture_traces.h>
+
+#define PROCESSOR DEVICE_DT_GET(DT_NODELABEL(gestures))
+
+// Gesture ids, param1 of each pattern's recorder binding in the overlay
+enum {
+    RIGHT,
+    LEFT,
+    RIGHT_LEFT,
+    DOWN_RIGHT,
+    DOWN_LEFT,
+    UP_RIGHT,
+};
+
+// Longer than commit-timeout-ms and gesture-cooldown-ms, so every gesture has fired
+#define SETTLE_TIME K_MSEC(500)
+
+// One stroke of a synthetic gesture, stroke-size is 300
+struct stroke {
+    int32_t dx;
+    int32_t dy;
+    int reports;
+};
+
+struct synthetic_gesture {
+    const char *name;
+    struct stroke strokes[3];
+    uint32_t expected[3];
+    size_t expected_count;
+    bool immediate;  // Unambiguous, so it fires on the stroke that completes it
+};
+
+static const struct synthetic_gesture synthetic_gestures[] = {
+    {"right", {{15, 0, 22}}, {RIGHT}, 1, false},
+    {"left", {{-15, 0, 22}}, {LEFT}, 1, true},
+    {"right left", {{15, 0, 22}, {-15, 0, 25}}, {RIGHT_LEFT}, 1, true},
+    {"down right", {{0, 15, 22}, {15, 0, 22}}, {DOWN_RIGHT}, 1, true},
+    {"down left", {{0, 15, 22}, {-15, 0, 22}}, {DOWN_LEFT}, 1, true},
+    {"up right", {{12, -12, 14}}, {UP_RIGHT}, 1, true},
+    {"up, no pattern", {{0, -15, 22}}, {0}, 0, false},
+    {"down up, dead end", {{0, 15, 22}, {0, -15, 25}}, {0}, 0, false},
+};
+
+static bool presses_match(const uint32_t *expected, size_t expected_count) {
+    uint32_t presses[GESTURE_TEST_MAX_EXPECTED];
+    size_t count = gesture_test_presses(presses, ARRAY_SIZE(presses));
+
+    if (count != expected_count) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (presses[i] != expected[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void print_cost(const struct gesture_replay_stats *stats) {
+    TC_PRINT("  handler: %u events, avg %llu ns, max %llu ns\n", stats->events,
+             (unsigned long long)timing_cycles_to_ns(stats->cycles / MAX(stats->events, 1)),
+             (unsigned long long)timing_cycles_to_ns(stats->max_cycles));
+}
+
+ZTEST(mouse_gesture, test_recorded_traces) {
+    struct gesture_replay_stats stats = {0};
+    size_t correct = 0;
+
+    zassert_true(ARRAY_SIZE(gesture_trace_files) > 0, "No traces embedded");
+
+    for (size_t i = 0; i < ARRAY_SIZE(gesture_trace_files); i++) {
+        const struct gesture_trace_file *trace = &gesture_trace_files[i];
+        uint32_t expected[GESTURE_TEST_MAX_EXPECTED];
+
+        gesture_test_calls_reset();
+        int expected_count =
+            gesture_replay(PROCESSOR, gesture_test_inputs[0], trace->text, expected, &stats);
+        zassert_true(expected_count >= 0, "Malformed trace %s", trace->name);
+        k_sleep(SETTLE_TIME);
+
+        bool match = presses_match(expected, expected_count);
+        TC_PRINT("  trace %s: %s\n", trace->name, match ? "ok" : "MISMATCH");
+        correct += match;
+    }
+
+    TC_PRINT("  accuracy: %zu/%zu traces\n", correct, ARRAY_SIZE(gesture_trace_files));
+    print_cost(&stats);
+    zassert_equal(correct, ARRAY_SIZE(gesture_trace_files), "Traces fired unexpected gestures");
+}
+
+ZTEST(mouse_gesture, test_synthetic_gestures) {
+    struct gesture_replay_stats stats = {0};
+    uint64_t latency_sum = 0;
+    uint64_t latency_max = 0;
+    size_t latency_count = 0;
+    size_t correct = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(synthetic_gestures); i++) {
+        const struct synthetic_gesture *gesture = &synthetic_gestures[i];
+
+        gesture_test_calls_reset();
+        gesture_test_activate(true);
+        for (size_t s = 0; s < ARRAY_SIZE(gesture->strokes) && gesture->strokes[s].reports; s++) {
+            gesture_test_stroke(PROCESSOR, gesture_test_inputs[0], gesture->strokes[s].dx,
+                                gesture->strokes[s].dy, gesture->strokes[s].reports, &stats);
+        }
+        k_sleep(SETTLE_TIME);
+        gesture_test_activate(false);
+
+        bool match = presses_match(gesture->expected, gesture->expected_count);
+        TC_PRINT("  %s: %s\n", gesture->name, match ? "ok" : "MISMATCH");
+        correct += match;
+
+        // Latency from the event that completed the gesture to the first binding call
+        struct gesture_test_call calls[4];
+        if (gesture->immediate && gesture_test_calls(calls, ARRAY_SIZE(calls)) > 0) {
+            latency_sum += calls[0].latency_ns;
+            latency_max = MAX(latency_max, calls[0].latency_ns);
+            latency_count++;
+        }
+
+        k_sleep(SETTLE_TIME);
+    }
+
+    TC_PRINT("  accuracy: %zu/%zu gestures\n", correct, ARRAY_SIZE(synthetic_gestures));
+    print_cost(&stats);
+    TC_PRINT("  match to execution: avg %llu ns, max %llu ns\n",
+             (unsigned long long)(latency_sum / MAX(latency_count, 1)),
+             (unsigned long long)latency_max);
+    zassert_equal(correct, ARRAY_SIZE(synthetic_gestures), "Gestures misrecognized");
+}
+
+ZTEST(mouse_gesture, test_bindings_go_through_the_behavior_queue) {
+    struct gesture_test_call calls[4];
+
+    gesture_test_activate(true);
+    gesture_test_stroke(PROCESSOR, gesture_test_inputs[0], -15, 0, 22, NULL);
+    k_sleep(SETTLE_TIME);
+    gesture_test_activate(false);
+
+    // Queued behind whatever an earlier gesture left in the behavior queue, and tapped
+    // without timers by default
+    zassert_equal(gesture_test_calls(calls, ARRAY_SIZE(calls)), 2,
+                  "Expected a press and a release");
+    zassert_true(calls[0].pressed && !calls[1].pressed, "Expected a press, then a release");
+    for (size_t i = 0; i < 2; i++) {
+        zassert_true(calls[i].queued, "Binding invoked past the behavior queue");
+        zassert_equal(calls[i].wait, 0, "Tap waits %u ms", calls[i].wait);
+    }
+}
+
+ZTEST(mouse_gesture, test_cooldown_holds_only_the_fire) {
+    static const uint32_t expected[] = {DOWN_RIGHT, RIGHT_LEFT};
+
+    // Right-left drawn right after a gesture still beats its <GESTURE_RIGHT> prefix
+    gesture_test_activate(true);
+    gesture_test_stroke(PROCESSOR, gesture_test_inputs[0], 0, 15, 22, NULL);
+    gesture_test_stroke(PROCESSOR, gesture_test_inputs[0], 15, 0, 22, NULL);
+    gesture_test_stroke(PROCESSOR, gesture_test_inputs[0], 15, 0, 22, NULL);
+    gesture_test_stroke(PROCESSOR, gesture_test_inputs[0], -15, 0, 25, NULL);
+
+    // Held until the cooldown ends
+    zassert_true(presses_match(expected, 1), "Gesture fired during the cooldown");
+    k_sleep(SETTLE_TIME);
+    gesture_test_activate(false);
+
+    zassert_true(presses_match(expected, ARRAY_SIZE(expected)), "Strokes lost to the cooldown");
+}
+
+static void *mouse_gesture_setup(void) {
+    timing_init();
+    timing_start();
+    return NULL;
+}
+
+static void mouse_gesture_before(void *fixture) {
+    ARG_UNUSED(fixture);
+
+    gesture_test_activate(false);
+    k_sleep(SETTLE_TIME);
+    gesture_test_calls_reset();
+}
+
+ZTEST_SUITE(mouse_gesture, NULL, mouse_gesture_setup, mouse_gesture_before, NULL, NULL);
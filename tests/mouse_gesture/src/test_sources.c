@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <zephyr/device.h>
+#include <zephyr/input/input.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "fakes.h"
+#include "replay.h"
+#include "stats.h"
+
+#define PROCESSOR DEVICE_DT_GET(DT_NODELABEL(gestures))
+
+// Gesture ids, param1 of each pattern's recorder binding in the overlay
+enum {
+    DOWN_RIGHT = 3,
+    DOWN_LEFT = 4,
+};
+
+// The third input device has to share the last source
+BUILD_ASSERT(CONFIG_ZMK_MOUSE_GESTURE_SOURCES == 2, "The test expects two gesture sources");
+
+// Longer than gesture-cooldown-ms, so every gesture has fired and the next may start
+#define SETTLE_TIME K_MSEC(500)
+
+#define FIRES_PER_THREAD 4
+#define FIRE_STACK_SIZE 2048
+
+static K_THREAD_STACK_ARRAY_DEFINE(fire_stacks, 2, FIRE_STACK_SIZE);
+static struct k_thread fire_threads[2];
+
+static int compare_params(const void *a, const void *b) {
+    return (int)*(const uint32_t *)a - (int)*(const uint32_t *)b;
+}
+
+// Draw one stroke on two input devices at once, their reports interleaved
+static void stroke_together(const struct device *a, int32_t dx_a, int32_t dy_a,
+                            const struct device *b, int32_t dx_b, int32_t dy_b, int reports) {
+    for (int i = 0; i < reports; i++) {
+        gesture_test_event(PROCESSOR, a, INPUT_REL_X, dx_a, false, NULL);
+        gesture_test_event(PROCESSOR, a, INPUT_REL_Y, dy_a, true, NULL);
+        gesture_test_event(PROCESSOR, b, INPUT_REL_X, dx_b, false, NULL);
+        gesture_test_event(PROCESSOR, b, INPUT_REL_Y, dy_b, true, NULL);
+        k_sleep(K_MSEC(1));
+    }
+}
+
+ZTEST(mouse_gesture_sources, test_devices_draw_independently) {
+    const struct device *a = gesture_test_inputs[0];
+    const struct device *b = gesture_test_inputs[1];
+    const struct device *c = gesture_test_inputs[2];
+    uint32_t presses[4];
+
+    // Down-right and down-left drawn at the same time don't mix into one sequence
+    gesture_test_activate(true);
+    stroke_together(a, 0, 15, b, 0, 15, 22);
+    stroke_together(a, 15, 0, b, -15, 0, 22);
+    k_sleep(SETTLE_TIME);
+    gesture_test_activate(false);
+
+    size_t count = gesture_test_presses(presses, ARRAY_SIZE(presses));
+    zassert_equal(count, 2, "Expected 2 gestures, got %zu", count);
+    qsort(presses, count, sizeof(presses[0]), compare_params);
+    zassert_equal(presses[0], DOWN_RIGHT, "Down-right lost");
+    zassert_equal(presses[1], DOWN_LEFT, "Down-left lost");
+
+    // A third device continues the sequence of the device whose source it shares
+    k_sleep(SETTLE_TIME);
+    gesture_test_calls_reset();
+    gesture_test_activate(true);
+    gesture_test_stroke(PROCESSOR, b, 0, 15, 22, NULL);
+    gesture_test_stroke(PROCESSOR, c, -15, 0, 22, NULL);
+    k_sleep(SETTLE_TIME);
+    gesture_test_activate(false);
+
+    count = gesture_test_presses(presses, ARRAY_SIZE(presses));
+    zassert_equal(count, 1, "Expected 1 gesture, got %zu", count);
+    zassert_equal(presses[0], DOWN_LEFT, "Shared source did not continue the sequence");
+}
+
+// Draws down-right or down-left on its own input device, one gesture per cooldown
+static void fire_main(void *p1, void *p2, void *p3) {
+    const struct device *input = p1;
+    int32_t dx = POINTER_TO_INT(p2);
+
+    ARG_UNUSED(p3);
+
+    for (int i = 0; i < FIRES_PER_THREAD; i++) {
+        gesture_test_stroke(PROCESSOR, input, 0, 15, 22, NULL);
+        gesture_test_stroke(PROCESSOR, input, dx, 0, 22, NULL);
+        k_sleep(SETTLE_TIME);
+    }
+}
+
+ZTEST(mouse_gesture_sources, test_concurrent_fires_all_execute) {
+    uint32_t presses[2 * FIRES_PER_THREAD + 1];
+    long overflows[2];
+
+    // The sample ring has a single producer, the input thread
+    if (IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)) {
+        ztest_test_skip();
+    }
+
+    zassert_ok(gesture_test_stat(PROCESSOR, "execution queue overflows", &overflows[0], 1));
+
+    // Both sources complete their gestures in the same millisecond and queue them from
+    // different threads
+    gesture_test_activate(true);
+    k_thread_create(&fire_threads[0], fire_stacks[0], K_THREAD_STACK_SIZEOF(fire_stacks[0]),
+                    fire_main, (void *)gesture_test_inputs[0], INT_TO_POINTER(15), NULL,
+                    K_PRIO_PREEMPT(5), 0, K_NO_WAIT);
+    k_thread_create(&fire_threads[1], fire_stacks[1], K_THREAD_STACK_SIZEOF(fire_stacks[1]),
+                    fire_main, (void *)gesture_test_inputs[1], INT_TO_POINTER(-15), NULL,
+                    K_PRIO_PREEMPT(5), 0, K_NO_WAIT);
+    k_thread_join(&fire_threads[0], K_FOREVER);
+    k_thread_join(&fire_threads[1], K_FOREVER);
+    gesture_test_activate(false);
+
+    size_t count = gesture_test_presses(presses, ARRAY_SIZE(presses));
+    zassert_equal(count, 2 * FIRES_PER_THREAD, "Expected %d gestures, got %zu",
+                  2 * FIRES_PER_THREAD, count);
+
+    size_t down_right = 0;
+    for (size_t i = 0; i < count; i++) {
+        zassert_true(presses[i] == DOWN_RIGHT || presses[i] == DOWN_LEFT,
+                     "Unexpected gesture %u", presses[i]);
+        down_right += presses[i] == DOWN_RIGHT;
+    }
+    zassert_equal(down_right, FIRES_PER_THREAD, "Gestures of one source lost");
+
+    zassert_ok(gesture_test_stat(PROCESSOR, "execution queue overflows", &overflows[1], 1));
+    zassert_equal(overflows[1], overflows[0], "Execution queue overflowed");
+}
+
+static void *sources_setup(void) {
+    gesture_test_stats_init();
+    return NULL;
+}
+
+static void sources_before(void *fixture) {
+    ARG_UNUSED(fixture);
+
+    gesture_test_activate(false);
+    k_sleep(SETTLE_TIME);
+    gesture_test_calls_reset();
+}
+
+ZTEST_SUITE(mouse_gesture_sources, NULL, sources_setup, sources_before, NULL, NULL);
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/device.h>
+#include <zephyr/input/input.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include "fakes.h"
+#include "replay.h"
+#include "stats.h"
+
+#define PROCESSOR DEVICE_DT_GET(DT_NODELABEL(gestures))
+
+// Gesture ids, param1 of each pattern's recorder binding in the overlay
+enum {
+    RIGHT = 0,
+    LEFT = 1,
+};
+
+// Longer than commit-timeout-ms and gesture-cooldown-ms, so every gesture has fired
+#define SETTLE_TIME K_MSEC(500)
+
+// Queue a stroke without yielding; the test thread is cooperative, so the recognizer
+// thread only sees it once the test sleeps
+static void queue_stroke(int32_t dx, int32_t dy, int reports) {
+    for (int i = 0; i < reports; i++) {
+        gesture_test_event(PROCESSOR, gesture_test_inputs[0], INPUT_REL_X, dx, false, NULL);
+        gesture_test_event(PROCESSOR, gesture_test_inputs[0], INPUT_REL_Y, dy, true, NULL);
+    }
+}
+
+ZTEST(mouse_gesture_thread, test_activation_edges_stay_ordered) {
+    static const uint32_t expected[] = {RIGHT, LEFT};
+    uint32_t presses[4];
+    long events[2];
+
+    if (!IS_ENABLED(CONFIG_ZMK_MOUSE_GESTURE_RECOGNIZER_THREAD)) {
+        ztest_test_skip();
+    }
+
+    zassert_ok(gesture_test_stat(PROCESSOR, "events", &events[0], 1));
+
+    // Right waits for a possible right-left, then the key is released and pressed again
+    // and left is drawn, all before the recognizer thread runs
+    gesture_test_activate(true);
+    queue_stroke(15, 0, 22);
+    gesture_test_activate(false);
+    gesture_test_activate(true);
+    queue_stroke(-15, 0, 25);
+
+    zassert_ok(gesture_test_stat(PROCESSOR, "events", &events[1], 1));
+    zassert_equal(events[1], events[0], "Recognizer thread ran before the activation edges");
+
+    // The release commits right with the first activation's motion only
+    k_sleep(SETTLE_TIME);
+    gesture_test_activate(false);
+
+    size_t count = gesture_test_presses(presses, ARRAY_SIZE(presses));
+    zassert_equal(count, ARRAY_SIZE(expected), "Expected %zu gestures, got %zu",
+                  ARRAY_SIZE(expected), count);
+    for (size_t i = 0; i < count; i++) {
+        zassert_equal(presses[i], expected[i], "Gesture %zu: expected %u, got %u", i,
+                      expected[i], presses[i]);
+    }
+}
+
+static void *thread_setup(void) {
+    gesture_test_stats_init();
+    return NULL;
+}
+
+static void thread_before(void *fixture) {
+    ARG_UNUSED(fixture);
+
+    gesture_test_activate(false);
+    k_sleep(SETTLE_TIME);
+    gesture_test_calls_reset();
+}
+
+ZTEST_SUITE(mouse_gesture_thread, NULL, thread_setup, thread_before, NULL, NULL);
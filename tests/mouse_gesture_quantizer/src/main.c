@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2024 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Exhaustive check of the direction quantizer against an atan2 reference, for every
+ * direction count and every dead zone width the devicetree binding accepts.
+ */
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <zephyr/ztest.h>
+
+#include <zmk/mouse_gesture_quantizer.h>
+
+// Thresholds are rounded to Q16, which moves an edge by less than 1e-3 degrees. Points
+// closer than this to a sector or dead zone edge may fall on either side of it.
+#define EDGE_TOLERANCE_DEG 0.002
+
+static const int direction_counts[] = {4, 8, 16};
+
+struct coverage {
+    uint32_t points;
+    uint32_t near_edge;
+};
+
+// Compass angle of a vector in degrees, clockwise from up with Y pointing down, in [0, 360)
+static double compass_deg(int32_t x, int32_t y) {
+    double deg = atan2((double)x, -(double)y) * 180.0 / M_PI;
+    return deg < 0 ? deg + 360.0 : deg;
+}
+
+static void check_point(const struct gesture_quantizer *quantizer, int directions,
+                        int dead_zone, int32_t x, int32_t y, struct coverage *coverage) {
+    double width = 360.0 / directions;
+    int step = GESTURE_DIRECTION_CODES / directions;
+    double deg = compass_deg(x, y);
+
+    // Nearest direction, and the angle from its center towards the nearest boundary
+    int nearest = (int)floor(deg / width + 0.5);
+    double from_center = deg - nearest * width;
+    int neighbour = from_center > 0 ? nearest + 1 : nearest - 1;
+    double to_edge = width / 2 - fabs(from_center) - dead_zone / 2.0;
+
+    uint8_t expected = to_edge < 0 ? GESTURE_SECTOR_NONE
+                                   : (uint8_t)((nearest * step) & (GESTURE_DIRECTION_CODES - 1));
+    uint8_t actual = gesture_detect_direction(x, y, quantizer);
+
+    coverage->points++;
+    if (fabs(to_edge) < EDGE_TOLERANCE_DEG) {
+        // Either side of the edge: the dead zone, or the neighbour without one
+        uint8_t other = dead_zone > 0
+                            ? GESTURE_SECTOR_NONE
+                            : (uint8_t)(((neighbour + directions) * step) &
+                                        (GESTURE_DIRECTION_CODES - 1));
+        uint8_t inside = (uint8_t)((nearest * step) & (GESTURE_DIRECTION_CODES - 1));
+
+        coverage->near_edge++;
+        zassert_true(actual == inside || actual == other,
+                     "%d directions, dead zone %d: (%d, %d) at %.6f deg gave %u, expected %u or %u",
+                     directions, dead_zone, x, y, deg, actual, inside, other);
+        return;
+    }
+
+    zassert_equal(actual, expected,
+                  "%d directions, dead zone %d: (%d, %d) at %.6f deg gave %u, expected %u",
+                  directions, dead_zone, x, y, deg, actual, expected);
+}
+
+// Point at a compass angle and distance from the origin
+static void point_at(double deg, double radius, int32_t *x, int32_t *y) {
+    *x = (int32_t)llround(radius * sin(deg * M_PI / 180.0));
+    *y = (int32_t)llround(-radius * cos(deg * M_PI / 180.0));
+}
+
+static void check_quantizer(int directions, int dead_zone, struct coverage *coverage) {
+    static const int32_t extremes[] = {INT32_MIN, INT32_MIN + 1, -1000, -1, 0,
+                                       1,         1000,          INT32_MAX};
+    static const double radii[] = {10, 300, 100000, 2000000000};
+    const struct gesture_quantizer quantizer = GESTURE_QUANTIZER_INIT(directions, dead_zone);
+    double width = 360.0 / directions;
+    int32_t x;
+    int32_t y;
+
+    // Axes, INT32_MIN and other extreme magnitudes
+    for (size_t i = 0; i < ARRAY_SIZE(extremes); i++) {
+        for (size_t j = 0; j < ARRAY_SIZE(extremes); j++) {
+            if (extremes[i] != 0 || extremes[j] != 0) {
+                check_point(&quantizer, directions, dead_zone, extremes[i], extremes[j],
+                            coverage);
+            }
+        }
+    }
+
+    // Full circle sweep
+    for (int i = 0; i < 7200; i++) {
+        for (size_t r = 0; r < ARRAY_SIZE(radii); r++) {
+            point_at(i * 0.05, radii[r], &x, &y);
+            check_point(&quantizer, directions, dead_zone, x, y, coverage);
+        }
+    }
+
+    // Every sector boundary and dead zone edge, and the points one count around them
+    for (int b = 0; b < directions; b++) {
+        double boundary = (b + 0.5) * width;
+        double edges[] = {boundary, boundary - dead_zone / 2.0, boundary + dead_zone / 2.0};
+
+        for (size_t e = 0; e < ARRAY_SIZE(edges); e++) {
+            for (size_t r = 0; r < ARRAY_SIZE(radii); r++) {
+                point_at(edges[e], radii[r], &x, &y);
+                for (int dx = -1; dx <= 1; dx++) {
+                    for (int dy = -1; dy <= 1; dy++) {
+                        check_point(&quantizer, directions, dead_zone,
+                                    (int32_t)CLAMP((int64_t)x + dx, INT32_MIN, INT32_MAX),
+                                    (int32_t)CLAMP((int64_t)y + dy, INT32_MIN, INT32_MAX),
+                                    coverage);
+                    }
+                }
+            }
+        }
+    }
+}
+
+ZTEST(mouse_gesture_quantizer, test_thresholds) {
+    for (size_t d = 0; d < ARRAY_SIZE(direction_counts); d++) {
+        int directions = direction_counts[d];
+        double width = 360.0 / directions;
+
+        for (int dead_zone = 0; dead_zone * directions < 360; dead_zone++) {
+            const struct gesture_quantizer quantizer =
+                GESTURE_QUANTIZER_INIT(directions, dead_zone);
+
+            zassert_equal(quantizer.boundary_count, directions / 4);
+            for (int b = 0; b < quantizer.boundary_count; b++) {
+                double boundary = (b + 0.5) * width;
+                double lower = atan(quantizer.lower[b] / 65536.0) * 180.0 / M_PI;
+                double upper = atan(quantizer.upper[b] / 65536.0) * 180.0 / M_PI;
+
+                // Steep thresholds are large in Q16, so compare the angles they stand for
+                zassert_true(fabs(lower - (boundary - dead_zone / 2.0)) < EDGE_TOLERANCE_DEG / 2,
+                             "%d directions, dead zone %d: lower[%d] at %.6f deg", directions,
+                             dead_zone, b, lower);
+                zassert_true(fabs(upper - (boundary + dead_zone / 2.0)) < EDGE_TOLERANCE_DEG / 2,
+                             "%d directions, dead zone %d: upper[%d] at %.6f deg", directions,
+                             dead_zone, b, upper);
+            }
+        }
+    }
+}
+
+ZTEST(mouse_gesture_quantizer, test_directions_match_atan2) {
+    for (size_t d = 0; d < ARRAY_SIZE(direction_counts); d++) {
+        int directions = direction_counts[d];
+        struct coverage coverage = {0};
+        int widths = 0;
+
+        for (int dead_zone = 0; dead_zone * directions < 360; dead_zone++) {
+            check_quantizer(directions, dead_zone, &coverage);
+            widths++;
+        }
+
+        TC_PRINT("  %d directions: %d dead zone widths, %u points, %u within %.3f deg of an "
+                 "edge\n",
+                 directions, widths, coverage.points, coverage.near_edge, EDGE_TOLERANCE_DEG);
+    }
+}
+
+ZTEST_SUITE(mouse_gesture_quantizer, NULL, NULL, NULL, NULL, NULL);